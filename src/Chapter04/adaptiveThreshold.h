@@ -0,0 +1,181 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 4 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#if !defined ATHRESHOLD
+#define ATHRESHOLD
+
+#include <vector>
+#include <algorithm>
+
+#include <opencv2/core.hpp>
+
+#include "integral.h"
+
+// Thresholds bands of rows of an image, in parallel.
+// Each band builds the integral image of the rows it needs only,
+// such that the full integral image is never stored.
+class BandThresholder : public cv::ParallelLoopBody {
+
+	const cv::Mat& image;
+	cv::Mat& binary;
+	int blockSize;    // size of the neighborhood
+	int delta;        // pixels are compared to (mean-delta)
+	int bandHeight;   // number of rows of a band
+
+  public:
+
+	BandThresholder(const cv::Mat& image, cv::Mat& binary, int blockSize, int delta, int bandHeight)
+		: image(image), binary(binary), blockSize(blockSize), delta(delta), bandHeight(bandHeight) {}
+
+	// processes the bands in range
+	void operator()(const cv::Range& range) const {
+
+		int nl= image.rows;
+		int nc= image.cols;
+		int half= blockSize/2;
+		int width= nc + blockSize;  // integral row of a border-extended image row
+		int area= blockSize*blockSize;
+		float scale= 1.0f/area;
+
+		// band integral image, computed modulo 2^32:
+		// window sums are exact since they cannot exceed 255*area
+		std::vector<unsigned int> sums((bandHeight + blockSize)*width);
+		std::vector<int> windows(nc);
+
+		for (int band= range.start; band < range.end; band++) {
+
+			int y0= band*bandHeight;
+			int y1= std::min(y0 + bandHeight, nl);
+			int nrows= y1 - y0 + blockSize;
+
+			// integral of image rows y0-half to y1+half-1 (replicated borders)
+			std::fill(sums.begin(), sums.begin() + width, 0);
+			for (int r= 1; r < nrows; r++) {
+
+				const uchar* data= image.ptr<uchar>(std::min(std::max(y0 - half + r - 1, 0), nl - 1));
+				const unsigned int* above= &sums[(r-1)*width];
+				unsigned int* current= &sums[r*width];
+
+				unsigned int rowSum= 0;
+				current[0]= 0;
+				int e= 1;
+				for (; e <= half; e++) { // left border
+					rowSum+= data[0];
+					current[e]= above[e] + rowSum;
+				}
+				for (int i= 0; i < nc; i++, e++) {
+					rowSum+= data[i];
+					current[e]= above[e] + rowSum;
+				}
+				for (; e < width; e++) { // right border
+					rowSum+= data[nc-1];
+					current[e]= above[e] + rowSum;
+				}
+			}
+
+			for (int j= y0; j < y1; j++) {
+
+				// window sums of the row, using wrap-around integer arithmetic
+				const int* top= reinterpret_cast<const int*>(&sums[(j-y0)*width]);
+				const int* bottom= reinterpret_cast<const int*>(&sums[(j-y0+blockSize)*width]);
+				windowSums(top, top + blockSize, bottom, bottom + blockSize, &windows[0], nc);
+
+				const uchar* data= image.ptr<uchar>(j);
+				uchar* output= binary.ptr<uchar>(j);
+
+				// apply adaptive threshold
+				for (int i= 0; i < nc; i++)
+					output[i]= data[i] > cvRound(windows[i]*scale) - delta ? 255 : 0;
+			}
+		}
+	}
+};
+
+// Adaptive thresholding of large images using integral images.
+// The image is processed in parallel bands of rows, each band
+// computing the integral image of its own rows (plus the neighborhood margin).
+// The memory used is therefore bounded by the band size
+// whatever the size of the image.
+// Same result as cv::adaptiveThreshold with ADAPTIVE_THRESH_MEAN_C and THRESH_BINARY.
+class AdaptiveThresholder {
+
+	int blockSize;    // size of the neighborhood (odd)
+	double threshold; // pixels are compared to (mean-threshold)
+	int bandHeight;   // number of rows processed at once by a thread
+
+  public:
+
+	AdaptiveThresholder() : blockSize(21), threshold(10.0), bandHeight(64) {}
+
+	// set the size of the neighborhood
+	void setBlockSize(int size) {
+
+		blockSize= size | 1; // must be odd
+	}
+
+	int getBlockSize() {
+
+		return blockSize;
+	}
+
+	// set the value subtracted from the mean
+	void setThreshold(double t) {
+
+		threshold= t;
+	}
+
+	double getThreshold() {
+
+		return threshold;
+	}
+
+	// set the number of rows of each band
+	void setBandHeight(int h) {
+
+		bandHeight= std::max(h, 1);
+	}
+
+	int getBandHeight() {
+
+		return bandHeight;
+	}
+
+	// number of bytes of integral image used by each thread
+	size_t bufferSize(int cols) {
+
+		return static_cast<size_t>(bandHeight + blockSize)*(cols + blockSize)*sizeof(unsigned int);
+	}
+
+	// threshold a gray-level image
+	void apply(const cv::Mat& image, cv::Mat& binary) {
+
+		CV_Assert(image.type() == CV_8U);
+
+		// rows are read by neighbouring bands
+		cv::Mat input= image.data == binary.data ? image.clone() : image;
+		binary.create(image.rows, image.cols, CV_8U);
+		int nBands= (image.rows + bandHeight - 1)/bandHeight;
+		// as in cv::adaptiveThreshold
+		int delta= cvCeil(threshold);
+
+		cv::parallel_for_(cv::Range(0, nBands),
+			BandThresholder(input, binary, blockSize, delta, bandHeight));
+	}
+};
+
+#endif
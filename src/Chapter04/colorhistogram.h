@@ -22,6 +22,8 @@ Copyright (C) 2016 Robert Laganiere, www.laganiere.name
 #include <opencv2\core\core.hpp>
 #include <opencv2\imgproc\imgproc.hpp>
 
+#include "compactHistogram.h"
+
 class ColorHistogram {
 
   private:
@@ -109,6 +111,19 @@ class ColorHistogram {
 		return hist;
 	}
 
+	// Computes the histogram as a sorted list of non-empty bins.
+	// Well suited for large bin counts.
+	CompactHistogram getCompactHistogram(const cv::Mat &image) {
+
+		CompactHistogram hist;
+		hist.setSize(histSize[0]);
+
+		// BGR color histogram with range [0,256[
+		hist.compute(image);
+
+		return hist;
+	}
+
 	// Computes the 1D Hue histogram.
 	// BGR source image is converted to HSV
 	// Pixels with low saturation are ignored
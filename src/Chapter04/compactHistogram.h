@@ -0,0 +1,315 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 4 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#if !defined CHISTOGRAM
+#define CHISTOGRAM
+
+#include <cmath>
+#include <cfloat>
+#include <vector>
+#include <algorithm>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+// A sparse 3D BGR histogram stored as a sorted list of non-empty bins.
+// The bin index (b*size+g)*size+r is used as a key; the keys are grouped
+// into buckets according to their most significant bits such that
+// a bin is found by a binary search over a few entries only.
+class CompactHistogram {
+
+  private:
+
+	int size;    // number of bins in each channel
+	int shift;   // number of key bits that are not part of the bucket index
+
+	std::vector<unsigned int> keys;     // sorted non-empty bins
+	std::vector<float> values;          // value of each non-empty bin
+	std::vector<unsigned int> buckets;  // index of the first key of each bucket
+
+	// contribution of each channel value to the key
+	unsigned int lut[3][256];
+
+	// prepares the look-up tables and the bucket layout
+	void setup() {
+
+		for (int v= 0; v < 256; v++) {
+
+			unsigned int bin= v*size/256; // uniform bins over [0,256[
+			lut[0][v]= bin*size*size;     // B
+			lut[1][v]= bin*size;          // G
+			lut[2][v]= bin;               // R
+		}
+
+		// number of bits needed to represent a key
+		int keyBits= 0;
+		while ((1ull << keyBits) < static_cast<unsigned long long>(size)*size*size)
+			keyBits++;
+
+		// at most 2^16 buckets
+		shift= std::max(keyBits - 16, 0);
+	}
+
+	int numberOfBuckets() const {
+
+		return static_cast<int>(((static_cast<unsigned long long>(size)*size*size - 1) >> shift) + 1);
+	}
+
+	unsigned int key(const uchar* pixel) const {
+
+		return lut[0][pixel[0]] + lut[1][pixel[1]] + lut[2][pixel[2]];
+	}
+
+	// value of the bin with this key
+	float lookup(unsigned int k) const {
+
+		unsigned int b= k >> shift;
+		const unsigned int* first= keys.data() + buckets[b];
+		const unsigned int* last= keys.data() + buckets[b+1];
+		const unsigned int* it= std::lower_bound(first, last, k);
+
+		return (it != last && *it == k) ? values[it - keys.data()] : 0.0f;
+	}
+
+  public:
+
+	CompactHistogram() : size(256), shift(0) {
+
+		setup();
+		buckets.assign(numberOfBuckets() + 1, 0);
+	}
+
+	// set histogram size for each dimension
+	// this clears the histogram
+	void setSize(int s) {
+
+		size= s;
+		setup();
+		keys.clear();
+		values.clear();
+		buckets.assign(numberOfBuckets() + 1, 0);
+	}
+
+	int getSize() const {
+
+		return size;
+	}
+
+	// number of non-empty bins
+	size_t nonZeroCount() const {
+
+		return keys.size();
+	}
+
+	// number of bytes used by the histogram data
+	size_t memorySize() const {
+
+		return (keys.size() + buckets.size())*sizeof(unsigned int) + values.size()*sizeof(float);
+	}
+
+	// value of a bin
+	float at(int b, int g, int r) const {
+
+		return lookup((static_cast<unsigned int>(b)*size + g)*size + r);
+	}
+
+	// Computes the histogram of a BGR image
+	void compute(const cv::Mat &image) {
+
+		CV_Assert(image.type() == CV_8UC3);
+
+		int nb= numberOfBuckets();
+		int nl= image.rows;
+		int nc= image.cols;
+
+		// first pass: count the pixels of each bucket
+		std::vector<unsigned int> start(nb + 1, 0);
+		for (int j= 0; j < nl; j++) {
+
+			const uchar* data= image.ptr<uchar>(j);
+			for (int i= 0; i < nc; i++, data+= 3)
+				start[(key(data) >> shift) + 1]++;
+		}
+
+		// start position of each bucket
+		for (int b= 1; b <= nb; b++)
+			start[b]+= start[b-1];
+
+		// second pass: distribute the keys into their bucket
+		std::vector<unsigned int> sorted(image.total());
+		std::vector<unsigned int> pos(start.begin(), start.end() - 1);
+		for (int j= 0; j < nl; j++) {
+
+			const uchar* data= image.ptr<uchar>(j);
+			for (int i= 0; i < nc; i++, data+= 3) {
+
+				unsigned int k= key(data);
+				sorted[pos[k >> shift]++]= k;
+			}
+		}
+
+		// sort each bucket and count the identical keys
+		keys.clear();
+		values.clear();
+		buckets.assign(nb + 1, 0);
+		for (int b= 0; b < nb; b++) {
+
+			buckets[b]= static_cast<unsigned int>(keys.size());
+			unsigned int* first= sorted.data() + start[b];
+			unsigned int* last= sorted.data() + start[b+1];
+			std::sort(first, last);
+
+			while (first != last) {
+
+				unsigned int* next= std::upper_bound(first, last, *first);
+				keys.push_back(*first);
+				values.push_back(static_cast<float>(next - first));
+				first= next;
+			}
+		}
+		buckets[nb]= static_cast<unsigned int>(keys.size());
+	}
+
+	// Normalizes the histogram values (NORM_L1, NORM_L2 or NORM_INF)
+	void normalize(double value= 1.0, int normType= cv::NORM_L2) {
+
+		double norm= 0.0;
+		for (size_t i= 0; i < values.size(); i++) {
+
+			double v= std::fabs(values[i]);
+			if (normType == cv::NORM_L1) norm+= v;
+			else if (normType == cv::NORM_L2) norm+= v*v;
+			else norm= std::max(norm, v);
+		}
+
+		if (normType == cv::NORM_L2)
+			norm= std::sqrt(norm);
+
+		if (norm > DBL_EPSILON) {
+
+			float scale= static_cast<float>(value/norm);
+			for (size_t i= 0; i < values.size(); i++)
+				values[i]*= scale;
+		}
+	}
+
+	// Backprojects the histogram on a BGR image.
+	// The result is an 8-bit image of the bin values multiplied by scale.
+	void backProject(const cv::Mat &image, cv::Mat &result, double scale= 255.0) const {
+
+		CV_Assert(image.type() == CV_8UC3);
+
+		result.create(image.rows, image.cols, CV_8U);
+		int nl= image.rows;
+		int nc= image.cols;
+
+		// neighbouring pixels often fall in the same bin
+		unsigned int lastKey= 0;
+		uchar lastValue= cv::saturate_cast<uchar>(lookup(0)*scale);
+
+		for (int j= 0; j < nl; j++) {
+
+			const uchar* data= image.ptr<uchar>(j);
+			uchar* output= result.ptr<uchar>(j);
+
+			for (int i= 0; i < nc; i++, data+= 3) {
+
+				unsigned int k= key(data);
+				if (k != lastKey) {
+
+					lastKey= k;
+					lastValue= cv::saturate_cast<uchar>(lookup(k)*scale);
+				}
+				output[i]= lastValue;
+			}
+		}
+	}
+
+	// Compares two histograms of same size.
+	// Same definitions as cv::compareHist for
+	// HISTCMP_CORREL, HISTCMP_CHISQR, HISTCMP_INTERSECT and HISTCMP_BHATTACHARYYA
+	double compare(const CompactHistogram &h, int method) const {
+
+		CV_Assert(size == h.size);
+		if (method != cv::HISTCMP_CORREL && method != cv::HISTCMP_CHISQR &&
+			method != cv::HISTCMP_INTERSECT && method != cv::HISTCMP_BHATTACHARYYA)
+			CV_Error(cv::Error::StsBadArg, "unsupported histogram comparison method");
+
+		double result= 0.0;
+		double s1= 0.0, s2= 0.0, s11= 0.0, s22= 0.0;
+
+		// merge the two sorted lists of bins
+		size_t i= 0, j= 0;
+		while (i < keys.size() || j < h.keys.size()) {
+
+			double v1= 0.0, v2= 0.0;
+			if (j == h.keys.size() || (i < keys.size() && keys[i] < h.keys[j])) {
+				v1= values[i++];
+			} else if (i == keys.size() || h.keys[j] < keys[i]) {
+				v2= h.values[j++];
+			} else {
+				v1= values[i++];
+				v2= h.values[j++];
+			}
+
+			switch (method) {
+
+			  case cv::HISTCMP_CHISQR:
+				if (std::fabs(v1) > DBL_EPSILON)
+					result+= (v1 - v2)*(v1 - v2)/v1;
+				break;
+
+			  case cv::HISTCMP_INTERSECT:
+				result+= std::min(v1, v2);
+				break;
+
+			  case cv::HISTCMP_BHATTACHARYYA:
+				result+= std::sqrt(v1*v2);
+				s1+= v1;
+				s2+= v2;
+				break;
+
+			  case cv::HISTCMP_CORREL:
+				result+= v1*v2;
+				s1+= v1;
+				s2+= v2;
+				s11+= v1*v1;
+				s22+= v2*v2;
+			}
+		}
+
+		if (method == cv::HISTCMP_BHATTACHARYYA) {
+
+			s1*= s2;
+			s1= std::fabs(s1) > FLT_EPSILON ? 1.0/std::sqrt(s1) : 1.0;
+			result= std::sqrt(std::max(1.0 - result*s1, 0.0));
+
+		} else if (method == cv::HISTCMP_CORREL) {
+
+			// empty bins also count in the correlation
+			double scale= 1.0/(static_cast<double>(size)*size*size);
+			double num= result - s1*s2*scale;
+			double denom2= (s11 - s1*s1*scale)*(s22 - s2*s2*scale);
+			result= std::fabs(denom2) > DBL_EPSILON ? num/std::sqrt(denom2) : 1.0;
+		}
+
+		return result;
+	}
+};
+
+#endif
@@ -0,0 +1,123 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 4 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+#include <iostream>
+using namespace std;
+
+#include <opencv2/core.hpp>
+#include <opencv2/highgui.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "colorhistogram.h"
+#include "contentFinder.h"
+#include "compactHistogram.h"
+
+#define NITERATIONS 10
+
+// average duration in ms of n calls
+#define TIME_IT(n, statement, duration) { \
+	int64 tinit= cv::getTickCount(); \
+	for (int k=0; k<n; k++) { statement; } \
+	duration= 1000.*(cv::getTickCount()-tinit)/cv::getTickFrequency()/n; }
+
+int main()
+{
+	// Read input images
+	cv::Mat image= cv::imread("waves.jpg");
+	cv::Mat image2= cv::imread("beach.jpg");
+	if (!image.data || !image2.data)
+		return 0; 
+
+	// 256x256x256 color histograms
+	ColorHistogram hc;
+	hc.setSize(256);
+
+	// reference region used for back projection
+	cv::Mat imageROI= image(cv::Rect(0,0,100,45)); // blue sky area
+
+	cv::Mat dense, dense2;
+	cv::SparseMat sparse, sparse2;
+	CompactHistogram compact, compact2;
+	double tDense, tSparse, tCompact;
+
+	//--------------
+	// Histogram computation
+	TIME_IT(NITERATIONS, dense= hc.getHistogram(image), tDense);
+	TIME_IT(NITERATIONS, sparse= hc.getSparseHistogram(image), tSparse);
+	TIME_IT(NITERATIONS, compact= hc.getCompactHistogram(image), tCompact);
+
+	cout << "Histogram of " << image.cols << "x" << image.rows << " image, 256 bins per channel" << endl;
+	cout << "non-empty bins: " << compact.nonZeroCount() << " (SparseMat: " << sparse.nzcount() << ")" << endl << endl;
+
+	cout << "computation time:" << endl;
+	cout << "  dense cv::Mat:    " << tDense << "ms" << endl;
+	cout << "  cv::SparseMat:    " << tSparse << "ms" << endl;
+	cout << "  CompactHistogram: " << tCompact << "ms" << endl << endl;
+
+	cout << "memory:" << endl;
+	cout << "  dense cv::Mat:    " << dense.total()*dense.elemSize()/1024 << "KB" << endl;
+	cout << "  cv::SparseMat:    " << (sparse.hdr->pool.size() + sparse.hdr->hashtab.size()*sizeof(size_t))/1024 << "KB" << endl;
+	cout << "  CompactHistogram: " << compact.memorySize()/1024 << "KB" << endl << endl;
+
+	//--------------
+	// Histogram comparison
+	dense2= hc.getHistogram(image2);
+	sparse2= hc.getSparseHistogram(image2);
+	compact2= hc.getCompactHistogram(image2);
+
+	double dDense, dSparse, dCompact;
+	TIME_IT(NITERATIONS, dDense= cv::compareHist(dense,dense2,cv::HISTCMP_INTERSECT), tDense);
+	TIME_IT(NITERATIONS, dSparse= cv::compareHist(sparse,sparse2,cv::HISTCMP_INTERSECT), tSparse);
+	TIME_IT(NITERATIONS, dCompact= compact.compare(compact2,cv::HISTCMP_INTERSECT), tCompact);
+
+	cout << "intersection waves vs beach:" << endl;
+	cout << "  dense cv::Mat:    " << dDense << " in " << tDense << "ms" << endl;
+	cout << "  cv::SparseMat:    " << dSparse << " in " << tSparse << "ms" << endl;
+	cout << "  CompactHistogram: " << dCompact << " in " << tCompact << "ms" << endl << endl;
+
+	//--------------
+	// Back projection of the sky region
+	dense= hc.getHistogram(imageROI);
+	sparse= hc.getSparseHistogram(imageROI);
+	compact= hc.getCompactHistogram(imageROI);
+	compact.normalize(1.0,cv::NORM_L2); // as done in ContentFinder
+
+	ContentFinder finder;
+	finder.setThreshold(-1.0f); // no thresholding
+	cv::Mat resultDense, resultSparse, resultCompact;
+
+	finder.setHistogram(dense);
+	TIME_IT(NITERATIONS, resultDense= finder.find(image), tDense);
+	finder.setHistogram(sparse);
+	TIME_IT(NITERATIONS, resultSparse= finder.find(image), tSparse);
+	TIME_IT(NITERATIONS, compact.backProject(image,resultCompact,255.0), tCompact);
+
+	cout << "back projection:" << endl;
+	cout << "  dense cv::Mat:    " << tDense << "ms" << endl;
+	cout << "  cv::SparseMat:    " << tSparse << "ms" << endl;
+	cout << "  CompactHistogram: " << tCompact << "ms" << endl;
+
+	cv::Mat tmp;
+	resultSparse.convertTo(tmp,CV_8U);
+	cout << "  pixels that differ from SparseMat result: " << cv::countNonZero(tmp!=resultCompact) << endl;
+
+	cv::namedWindow("Compact backprojection");
+	cv::imshow("Compact backprojection",resultCompact);
+
+	cv::waitKey();
+	return 0;
+}
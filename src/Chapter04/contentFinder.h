@@ -21,6 +21,98 @@ Copyright (C) 2016 Robert Laganiere, www.laganiere.name
 
 #include <opencv2\core\core.hpp>
 #include <opencv2\imgproc\imgproc.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+
+#include <vector>
+
+// Back projection of a dense histogram on an 8-bit image, in parallel row stripes.
+// Each pixel is mapped to its bin by adding the bin offsets read from
+// one look-up table per histogram dimension; the bin is then mapped
+// to its 8-bit output value (scaled or thresholded) in a single pass.
+class BackProjector : public cv::ParallelLoopBody {
+
+	const cv::Mat& image;
+	cv::Mat& result;
+	const int* channels;   // image channel of each of the 3 dimensions
+	const int* offsets;    // 3 tables of 256 bin offsets (total if out of range)
+	const uchar* table;    // output value of each bin, 0 at index total
+	int total;             // number of bins
+	const int* shifts;     // with power of 2 bins over [0,256[:
+	const int* steps;      // offset= (value>>shift)<<step
+	bool usePow2;
+
+  public:
+
+	BackProjector(const cv::Mat& image, cv::Mat& result, const int* channels,
+		          const int* offsets, const uchar* table, int total,
+				  const int* shifts, const int* steps, bool usePow2)
+		: image(image), result(result), channels(channels), offsets(offsets),
+		  table(table), total(total), shifts(shifts), steps(steps), usePow2(usePow2) {}
+
+	void operator()(const cv::Range& range) const {
+
+		int cn= image.channels();
+		int nc= image.cols;
+		const int* o0= offsets;
+		const int* o1= offsets + 256;
+		const int* o2= offsets + 512;
+
+		for (int j= range.start; j < range.end; j++) {
+
+			const uchar* data= image.ptr<uchar>(j);
+			uchar* output= result.ptr<uchar>(j);
+			int i= 0;
+
+#if CV_SIMD128
+			// bin indices of 16 pixels are computed with shifts
+			// and the bin values are then gathered
+			if (usePow2 && (cn == 1 || cn == 3)) {
+
+				unsigned int idx[16];
+				cv::v_uint8x16 c[3];
+
+				for (; i <= nc - 16; i+= 16, data+= 16*cn) {
+
+					if (cn == 1)
+						c[0]= cv::v_load(data);
+					else
+						cv::v_load_deinterleave(data, c[0], c[1], c[2]);
+
+					cv::v_uint32x4 sum[4];
+					for (int q= 0; q < 4; q++)
+						sum[q]= cv::v_setzero_u32();
+
+					for (int k= 0; k < 3; k++) {
+
+						if (shifts[k] < 0) // unused dimension
+							continue;
+
+						cv::v_uint16x8 lo, hi;
+						cv::v_uint32x4 a[4];
+						cv::v_expand(c[channels[k]], lo, hi);
+						cv::v_expand(lo >> shifts[k], a[0], a[1]);
+						cv::v_expand(hi >> shifts[k], a[2], a[3]);
+
+						for (int q= 0; q < 4; q++)
+							sum[q]= sum[q] | (a[q] << steps[k]);
+					}
+
+					for (int q= 0; q < 4; q++)
+						cv::v_store(idx + 4*q, sum[q]);
+
+					for (int t= 0; t < 16; t++)
+						output[i+t]= table[idx[t]];
+				}
+			}
+#endif
+			for (; i < nc; i++, data+= cn) {
+
+				int idx= o0[data[channels[0]]] + o1[data[channels[1]]] + o2[data[channels[2]]];
+				output[i]= table[std::min(idx, total)];
+			}
+		}
+	}
+};
 
 class ContentFinder {
 
@@ -36,9 +128,86 @@ class ContentFinder {
 	cv::SparseMat shistogram;  // or not
 	bool isSparse;
 
+	// output value of each bin of the dense histogram
+	// for the current threshold
+	std::vector<uchar> table;
+	float tableThreshold;
+
+	// Back projection and thresholding in a single parallel pass.
+	// Only for 8-bit images and dense float histograms of 1 to 3 dimensions.
+	// Same result as calcBackProject followed by threshold.
+	bool backProject(const cv::Mat& image, const int* channels, cv::Mat& result) {
+
+		// 1D histograms are Nx1 matrices
+		int dims= (histogram.dims == 2 && histogram.size[1] == 1) ? 1 : histogram.dims;
+		if (histogram.empty() || image.depth() != CV_8U || histogram.type() != CV_32F || dims > 3)
+			return false;
+
+		int ch[3]= { 0, 0, 0 };
+		for (int k= 0; k < dims; k++) {
+
+			if (channels[k] < 0 || channels[k] >= image.channels())
+				return false;
+			ch[k]= channels[k];
+		}
+
+		int total= static_cast<int>(histogram.total());
+
+		// output value of each bin, the last entry is for out of range pixels
+		if (table.empty() || tableThreshold != threshold) {
+
+			table.assign(total + 1, 0);
+			const float* h= histogram.ptr<float>();
+			for (int i= 0; i < total; i++) {
+
+				uchar v= cv::saturate_cast<uchar>(h[i]*255.0);
+				if (threshold > 0.0)
+					v= v > 255.0*threshold ? 255 : 0;
+				table[i]= v;
+			}
+			tableThreshold= threshold;
+		}
+
+		// bin offset of each value in each dimension
+		// unused dimensions have null offsets
+		std::vector<int> offsets(3*256, 0);
+		int shifts[3]= { -1, -1, -1 };
+		int steps[3]= { 0, 0, 0 };
+		bool usePow2= hranges[0] == 0.0f && hranges[1] == 256.0f;
+
+		int step= 1;
+		for (int k= dims - 1; k >= 0; k--) {
+
+			int size= histogram.size[k];
+			double a= size/static_cast<double>(hranges[1] - hranges[0]);
+			double b= -a*hranges[0];
+
+			for (int v= 0; v < 256; v++) {
+
+				int idx= cvFloor(v*a + b);
+				offsets[k*256 + v]= (idx >= 0 && idx < size) ? idx*step : total;
+			}
+
+			// power of 2 sizes give bit fields
+			int bits= 0;
+			while ((1 << bits) < size) bits++;
+			usePow2= usePow2 && (1 << bits) == size && bits <= 8;
+			shifts[k]= 8 - bits;
+			for (steps[k]= 0; (1 << steps[k]) < step; steps[k]++);
+
+			step*= size;
+		}
+
+		result.create(image.rows, image.cols, CV_8U);
+		cv::parallel_for_(cv::Range(0, image.rows),
+			BackProjector(image, result, ch, &offsets[0], &table[0], total, shifts, steps, usePow2));
+
+		return true;
+	}
+
   public:
 
-	ContentFinder() : threshold(0.1f), isSparse(false) {
+	ContentFinder() : threshold(0.1f), isSparse(false), tableThreshold(0.0f) {
 
 		// in this class,
 		// all channels have the same range
@@ -64,6 +233,7 @@ class ContentFinder {
 
 		isSparse= false;
 		cv::normalize(h,histogram,1.0);
+		table.clear();
 	}
 
 	// Sets the reference histogram
@@ -115,6 +285,10 @@ class ContentFinder {
 		   for (int i=0; i<histogram.dims; i++)
 			  this->channels[i]= channels[i];
 
+		   // single pass back projection and thresholding
+		   if (backProject(image, channels, result))
+			   return result;
+
 		   cv::calcBackProject(&image,
                       1,            // we only use one image at a time
                       channels,     // vector specifying what histogram dimensions belong to what image channels
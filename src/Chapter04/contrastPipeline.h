@@ -0,0 +1,316 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 4 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#if !defined CPIPELINE
+#define CPIPELINE
+
+#include <vector>
+#include <algorithm>
+
+#include <opencv2/core.hpp>
+
+#include "videoprocessor.h"
+
+// Applies a look-up table to bands of rows of an 8-bit image, in parallel,
+// and samples the histogram of the input in the same pass.
+// The table is applied by cv::LUT on each band, which uses the
+// vectorized implementation of the library.
+// One histogram of 256 bins is accumulated per band.
+class LookUpSampler : public cv::ParallelLoopBody {
+
+	const cv::Mat& image;
+	cv::Mat& result;
+	const cv::Mat& lookup;
+	int bandHeight;
+	int step;        // one pixel out of step is sampled in each direction (0 for none)
+	int xOffset;     // first sampled column
+	int yOffset;     // first sampled row
+	int* histograms; // 256 bins for each band
+
+  public:
+
+	LookUpSampler(const cv::Mat& image, cv::Mat& result, const cv::Mat& lookup, int bandHeight,
+		          int step, int xOffset, int yOffset, int* histograms)
+		: image(image), result(result), lookup(lookup), bandHeight(bandHeight),
+		  step(step), xOffset(xOffset), yOffset(yOffset), histograms(histograms) {}
+
+	// processes the bands in range
+	void operator()(const cv::Range& range) const {
+
+		int cn= image.channels();
+		int nc= image.cols*cn;
+		cv::Mat out;
+
+		for (int band= range.start; band < range.end; band++) {
+
+			int y0= band*bandHeight;
+			int y1= std::min(y0 + bandHeight, image.rows);
+			int* hist= histograms + band*256;
+			std::fill(hist, hist + 256, 0);
+
+			// sample the input rows of the band
+			if (step > 0) {
+
+				for (int j= y0 + (step + yOffset - y0%step)%step; j < y1; j+= step) {
+
+					const uchar* data= image.ptr<uchar>(j);
+					for (int i= xOffset*cn; i < nc; i+= step*cn)
+						for (int c= 0; c < cn; c++)
+							hist[data[i+c]]++;
+				}
+			}
+
+			// apply the look-up table to the band while it is still in cache
+			out= result.rowRange(y0, y1);
+			cv::LUT(image.rowRange(y0, y1), lookup, out);
+		}
+	}
+};
+
+// Automatic contrast enhancement of a video.
+// Each frame is mapped with a look-up table computed from the histogram
+// of the previous frames, such that the look-up table is applied and the next
+// histogram sampled in a single pass over the frame.
+// The histogram is computed on a subsampled grid whose offset changes
+// at each frame, and the look-up table is smoothed over time to avoid flicker.
+// The same table is applied to all channels of a color frame.
+class ContrastPipeline : public FrameProcessor {
+
+  public:
+
+	enum Method { STRETCH, EQUALIZE };
+
+  private:
+
+	int method;          // STRETCH or EQUALIZE
+	float percentile;    // fraction of the pixels saturated at each end when stretching
+	int step;            // sampling step in each direction
+	float smoothing;     // weight of the look-up table of the current frame
+	int bandHeight;      // number of rows processed at once by a thread
+	bool reset;          // true if the look-up table must be initialized
+	long frameNumber;
+
+	float table[256];                 // smoothed look-up table
+	cv::Mat lookup;                   // its 8-bit version
+	std::vector<int> histograms;      // one histogram per band
+	int histogram[256];               // sampled histogram of the last frame
+
+	double latency;      // processing time of the last frame (ms)
+	double totalLatency; // accumulated processing time (ms)
+
+	// look-up table stretching the sampled histogram
+	void stretchTable(float* t, int total) {
+
+		// number of pixels in percentile
+		float number= total*percentile;
+
+		// find left extremity of the histogram
+		int imin= 0;
+		for (float count=0.0; imin < 256; imin++) {
+			if ((count+= histogram[imin]) >= number)
+				break;
+		}
+
+		// find right extremity of the histogram
+		int imax= 255;
+		for (float count=0.0; imax >= 0; imax--) {
+			if ((count+= histogram[imax]) >= number)
+				break;
+		}
+
+		for (int i= 0; i < 256; i++) {
+
+			if (i < imin) t[i]= 0.0f;
+			else if (i >= imax) t[i]= 255.0f;
+			else t[i]= 255.0f*(i - imin)/(imax - imin);
+		}
+	}
+
+	// look-up table equalizing the sampled histogram
+	// as in cv::equalizeHist
+	void equalizeTable(float* t, int total) {
+
+		int i= 0;
+		while (i < 255 && !histogram[i])
+			i++;
+
+		if (histogram[i] == total) { // uniform image
+			std::fill(t, t + 256, static_cast<float>(i));
+			return;
+		}
+
+		float scale= 255.0f/(total - histogram[i]);
+		int sum= 0;
+		std::fill(t, t + i + 1, 0.0f);
+		for (i++; i < 256; i++) {
+
+			sum+= histogram[i];
+			t[i]= std::min(sum*scale, 255.0f);
+		}
+	}
+
+	// computes the new look-up table from the sampled histogram
+	void updateTable() {
+
+		int total= 0;
+		for (int i= 0; i < 256; i++)
+			total+= histogram[i];
+		if (total == 0)
+			return;
+
+		float t[256];
+		if (method == EQUALIZE)
+			equalizeTable(t, total);
+		else
+			stretchTable(t, total);
+
+		// temporal smoothing
+		float alpha= reset ? 1.0f : smoothing;
+		uchar* l= lookup.ptr<uchar>();
+		for (int i= 0; i < 256; i++) {
+
+			table[i]= alpha*t[i] + (1.0f - alpha)*table[i];
+			l[i]= cv::saturate_cast<uchar>(table[i]);
+		}
+
+		reset= false;
+	}
+
+	// applies the look-up table and samples the histogram in one pass
+	void apply(const cv::Mat& input, cv::Mat& output, bool sample) {
+
+		output.create(input.rows, input.cols, input.type());
+
+		int nBands= (input.rows + bandHeight - 1)/bandHeight;
+		histograms.resize(nBands*256);
+
+		// the sampling grid moves at each frame
+		// such that all pixels are eventually sampled
+		int xOffset= static_cast<int>((frameNumber/step)%step);
+		int yOffset= static_cast<int>(frameNumber%step);
+
+		cv::parallel_for_(cv::Range(0, nBands),
+			LookUpSampler(input, output, lookup, bandHeight,
+			              sample ? step : 0, xOffset, yOffset, &histograms[0]));
+
+		// merge the histograms of the bands
+		if (sample) {
+
+			std::fill(histogram, histogram + 256, 0);
+			for (int b= 0; b < nBands; b++)
+				for (int i= 0; i < 256; i++)
+					histogram[i]+= histograms[b*256 + i];
+		}
+	}
+
+  public:
+
+	ContrastPipeline() : method(STRETCH), percentile(0.01f), step(4), smoothing(0.1f),
+		bandHeight(32), reset(true), frameNumber(0), lookup(1, 256, CV_8U),
+		latency(0.0), totalLatency(0.0) {
+
+		for (int i= 0; i < 256; i++) {
+
+			table[i]= static_cast<float>(i);
+			lookup.at<uchar>(i)= static_cast<uchar>(i);
+		}
+	}
+
+	// set the contrast enhancement method (STRETCH or EQUALIZE)
+	void setMethod(int m) {
+
+		method= m;
+		reset= true;
+	}
+
+	// set the fraction of pixels saturated at each end of the range (STRETCH)
+	void setPercentile(float p) {
+
+		percentile= p;
+	}
+
+	// set the sampling step of the histogram in each direction
+	// (1 to use all pixels)
+	void setSamplingStep(int s) {
+
+		step= std::max(s, 1);
+	}
+
+	// set the weight of the current frame in the smoothed look-up table
+	// (1 for no smoothing)
+	void setSmoothing(float s) {
+
+		smoothing= s;
+	}
+
+	// restart the pipeline on the next frame
+	void restart() {
+
+		reset= true;
+	}
+
+	// the current 8-bit look-up table
+	const cv::Mat& getLookUpTable() {
+
+		return lookup;
+	}
+
+	// processing time of the last frame in ms
+	double getLatency() {
+
+		return latency;
+	}
+
+	// average processing time per frame in ms
+	double getAverageLatency() {
+
+		return frameNumber ? totalLatency/frameNumber : 0.0;
+	}
+
+	// processing method
+	void process(cv::Mat &frame, cv::Mat &output) {
+
+		CV_Assert(frame.depth() == CV_8U);
+
+		int64 time= cv::getTickCount();
+
+		if (reset) {
+
+			// no look-up table yet:
+			// the histogram of the frame is sampled first
+			apply(frame, output, true);
+			updateTable();
+			apply(frame, output, false);
+
+		} else {
+
+			// the table computed on the previous frames is applied
+			// while the histogram of this frame is sampled
+			apply(frame, output, true);
+			updateTable();
+		}
+
+		frameNumber++;
+
+		time= cv::getTickCount() - time;
+		latency= 1000.0*time/cv::getTickFrequency();
+		totalLatency+= latency;
+	}
+};
+
+#endif
@@ -0,0 +1,78 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 4 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/highgui.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "videoprocessor.h"
+#include "contrastPipeline.h"
+
+int main()
+{
+	// Create video procesor instance
+	VideoProcessor processor;
+
+	// generate the filename
+	std::vector<std::string> imgs;
+	std::string prefix = "goose/goose";
+	std::string ext = ".bmp";
+
+	// Add the image names of the sequence
+	for (long i = 130; i < 317; i++) {
+
+		std::string name(prefix);
+		std::ostringstream ss; ss << std::setfill('0') << std::setw(3) << i; name += ss.str();
+		name += ext;
+
+		imgs.push_back(name);
+	}
+
+	// Create the contrast enhancement instance
+	ContrastPipeline contrast;
+	contrast.setMethod(ContrastPipeline::STRETCH);
+	contrast.setPercentile(0.01f);  // 1% of the pixels at black and 1% at white
+	contrast.setSamplingStep(4);    // histogram of 1 pixel out of 16
+	contrast.setSmoothing(0.1f);    // look-up table smoothed over about 10 frames
+
+	// Open image sequence
+	processor.setInput(imgs);
+
+	// set frame processor
+	processor.setFrameProcessor(&contrast);
+
+	// Declare windows to display the video
+	processor.displayInput("Input");
+	processor.displayOutput("Enhanced contrast");
+
+	// Define the frame rate for display
+	processor.setDelay(50);
+
+	// Start the processing
+	processor.run();
+
+	std::cout << "average latency= " << contrast.getAverageLatency() << "ms per frame" << std::endl;
+
+	cv::waitKey();
+}
@@ -283,4 +283,11 @@ class Histogram1D {
 };
 
 
+// true if a higher score of the given comparison method means more similar histograms
+inline bool higherIsBetter(int method) {
+
+	return method == cv::HISTCMP_CORREL || method == cv::HISTCMP_INTERSECT;
+}
+
+
 #endif
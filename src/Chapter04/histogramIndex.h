@@ -0,0 +1,505 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 4 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#if !defined HINDEX
+#define HINDEX
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#if defined _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "histogram.h"
+#include "colorhistogram.h"
+
+// Read-only view of a file mapped in memory
+class MappedFile {
+
+	const char* data;  // start of the mapped region
+	size_t length;     // size of the mapped region in bytes
+
+#if defined _WIN32
+	HANDLE file;
+	HANDLE mapping;
+#else
+	int fd;
+#endif
+
+	MappedFile(const MappedFile&)= delete;
+	MappedFile& operator=(const MappedFile&)= delete;
+
+  public:
+
+#if defined _WIN32
+	MappedFile() : data(0), length(0), file(INVALID_HANDLE_VALUE), mapping(0) {}
+#else
+	MappedFile() : data(0), length(0), fd(-1) {}
+#endif
+
+	~MappedFile() {
+
+		close();
+	}
+
+	// maps the whole file in memory
+	bool open(const std::string& filename) {
+
+		close();
+
+#if defined _WIN32
+		file= CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, 0,
+			              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+			close();
+			return false;
+		}
+
+		mapping= CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+		if (!mapping) {
+			close();
+			return false;
+		}
+
+		data= static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		if (!data) {
+			close();
+			return false;
+		}
+
+		length= static_cast<size_t>(size.QuadPart);
+#else
+		fd= ::open(filename.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size == 0) {
+			close();
+			return false;
+		}
+
+		void* p= mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (p == MAP_FAILED) {
+			close();
+			return false;
+		}
+
+		data= static_cast<const char*>(p);
+		length= static_cast<size_t>(st.st_size);
+#endif
+		return true;
+	}
+
+	// releases the mapping
+	void close() {
+
+#if defined _WIN32
+		if (data) UnmapViewOfFile(data);
+		if (mapping) CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+		mapping= 0;
+		file= INVALID_HANDLE_VALUE;
+#else
+		if (data) munmap(const_cast<char*>(data), length);
+		if (fd >= 0) ::close(fd);
+		fd= -1;
+#endif
+		data= 0;
+		length= 0;
+	}
+
+	bool isOpen() const {
+
+		return data != 0;
+	}
+
+	const char* ptr() const {
+
+		return data;
+	}
+
+	size_t size() const {
+
+		return length;
+	}
+};
+
+// Computes the scores of a set of histograms stored contiguously
+// (one row of length values per image) against a query histogram
+class HistogramScorer : public cv::ParallelLoopBody {
+
+	const float* data;              // first histogram
+	int length;                     // number of values per histogram
+	const std::vector<int>* rows;   // rows to score (all rows if null)
+	cv::Mat query;                  // 1xlength query histogram
+	int method;                     // cv::HISTCMP_* method
+	std::vector<double>& scores;    // one score per scored row
+
+  public:
+
+	HistogramScorer(const float* data, int length, const std::vector<int>* rows,
+		            const cv::Mat& query, int method, std::vector<double>& scores)
+		: data(data), length(length), rows(rows), query(query), method(method), scores(scores) {}
+
+	void operator()(const cv::Range& range) const {
+
+		for (int i= range.start; i < range.end; i++) {
+
+			size_t row= rows ? (*rows)[i] : i;
+			// wrap the stored histogram without copying it
+			cv::Mat h(1, length, CV_32F, const_cast<float*>(data + row*length));
+			scores[i]= cv::compareHist(query, h, method);
+		}
+	}
+};
+
+// An image retrieval index made of BGR color histograms.
+// Histograms are normalized to unit sum such that images of different sizes
+// can be compared. Each image also has a coarse histogram (coarseBins per channel)
+// that is used to pre-select the candidates before the full comparison.
+// The index can be saved to a binary file which is memory mapped when loaded.
+class HistogramIndex {
+
+  private:
+
+	ColorHistogram hist;
+	int nBins;        // number of bins used in each color channel
+	int coarseBins;   // number of bins in each channel of the pre-filter histogram
+	int method;       // histogram comparison method
+	int nCandidates;  // number of images kept by the pre-filter
+
+	// histograms of the images added in memory
+	std::vector<float> fineData;
+	std::vector<float> coarseData;
+	// or of the images read from a mapped index file
+	MappedFile file;
+
+	const float* fine;    // first full histogram (one row per image)
+	const float* coarse;  // first coarse histogram (one row per image)
+	std::vector<std::string> names;
+
+	// header of the index file
+	// followed by the full histograms, the coarse histograms
+	// and the null-terminated image names
+	struct FileHeader {
+
+		char magic[4];      // "HIDX"
+		int version;
+		int nBins;
+		int coarseBins;
+		long long count;    // number of images
+	};
+
+	int fineLength() const {
+
+		return nBins*nBins*nBins;
+	}
+
+	int coarseLength() const {
+
+		return coarseBins*coarseBins*coarseBins;
+	}
+
+	// copies the mapped histograms in memory such that new images can be added
+	void detach() {
+
+		if (!file.isOpen())
+			return;
+
+		fineData.assign(fine, fine + names.size()*fineLength());
+		coarseData.assign(coarse, coarse + names.size()*coarseLength());
+		file.close();
+	}
+
+	// sets the histogram pointers to the in-memory data
+	void attach() {
+
+		fine= fineData.empty() ? 0 : &fineData[0];
+		coarse= coarseData.empty() ? 0 : &coarseData[0];
+	}
+
+	// computes the normalized full histogram of an image
+	cv::Mat getHistogram(const cv::Mat& image) {
+
+		hist.setSize(nBins);
+		cv::Mat h= hist.getHistogram(image);
+		cv::normalize(h, h, 1.0, 0.0, cv::NORM_L1);
+
+		return h;
+	}
+
+	// reduces a full histogram to a coarse one by summing the bins
+	// for the intersection, the coarse score is an upper bound of the full one
+	cv::Mat getCoarseHistogram(const cv::Mat& h) {
+
+		cv::Mat c(1, coarseLength(), CV_32F, cv::Scalar(0));
+		float* out= c.ptr<float>(0);
+		const float* in= h.ptr<float>();
+		int f= nBins/coarseBins; // number of bins merged in each channel
+
+		for (int b= 0; b < nBins; b++)
+			for (int g= 0; g < nBins; g++)
+				for (int r= 0; r < nBins; r++)
+					out[((b/f)*coarseBins + g/f)*coarseBins + r/f]+= *in++;
+
+		return c;
+	}
+
+  public:
+
+	HistogramIndex() : nBins(8), coarseBins(2), method(cv::HISTCMP_INTERSECT),
+		               nCandidates(256), fine(0), coarse(0) {}
+
+	// Set number of bins used in each color channel.
+	// Must be a multiple of the coarse number of bins
+	// and can only be changed on an empty index.
+	void setNumberOfBins(int bins) {
+
+		if (size() == 0 && bins%coarseBins == 0)
+			nBins= bins;
+	}
+
+	int getNumberOfBins() {
+
+		return nBins;
+	}
+
+	// Set the histogram comparison method (cv::HISTCMP_*)
+	void setComparisonMethod(int m) {
+
+		method= m;
+	}
+
+	int getComparisonMethod() {
+
+		return method;
+	}
+
+	// Set the number of images kept by the coarse pre-filter
+	// 0 means that all images are fully compared
+	void setNumberOfCandidates(int n) {
+
+		nCandidates= n;
+	}
+
+	int getNumberOfCandidates() {
+
+		return nCandidates;
+	}
+
+	// number of images in the index
+	int size() const {
+
+		return static_cast<int>(names.size());
+	}
+
+	// name of the image at this index
+	const std::string& getName(int i) const {
+
+		return names[i];
+	}
+
+	// adds the histogram of an image to the index
+	void add(const std::string& name, const cv::Mat& image) {
+
+		detach();
+
+		cv::Mat h= getHistogram(image);
+		cv::Mat c= getCoarseHistogram(h);
+
+		fineData.insert(fineData.end(), h.ptr<float>(), h.ptr<float>() + fineLength());
+		coarseData.insert(coarseData.end(), c.ptr<float>(0), c.ptr<float>(0) + coarseLength());
+		names.push_back(name);
+
+		attach();
+	}
+
+	// writes the index to a binary file
+	bool save(const std::string& filename) {
+
+		FILE* f= fopen(filename.c_str(), "wb");
+		if (!f)
+			return false;
+
+		FileHeader header;
+		memcpy(header.magic, "HIDX", 4);
+		header.version= 1;
+		header.nBins= nBins;
+		header.coarseBins= coarseBins;
+		header.count= names.size();
+
+		bool ok= fwrite(&header, sizeof(header), 1, f) == 1;
+		if (names.size()) {
+			ok= ok && fwrite(fine, sizeof(float)*fineLength(), names.size(), f) == names.size();
+			ok= ok && fwrite(coarse, sizeof(float)*coarseLength(), names.size(), f) == names.size();
+		}
+		for (size_t i= 0; ok && i < names.size(); i++)
+			ok= fwrite(names[i].c_str(), names[i].size() + 1, 1, f) == 1;
+
+		return fclose(f) == 0 && ok;
+	}
+
+	// maps an index file in memory
+	// the histograms are not copied, only the image names are read
+	bool load(const std::string& filename) {
+
+		fineData.clear();
+		coarseData.clear();
+		names.clear();
+		attach();
+
+		if (!file.open(filename))
+			return false;
+
+		const char* p= file.ptr();
+		const char* end= p + file.size();
+
+		FileHeader header;
+		if (file.size() < sizeof(header)) {
+			file.close();
+			return false;
+		}
+		memcpy(&header, p, sizeof(header));
+		p+= sizeof(header);
+
+		if (memcmp(header.magic, "HIDX", 4) != 0 || header.version != 1 ||
+			header.nBins <= 0 || header.nBins > 256 || header.coarseBins <= 0 ||
+			header.nBins%header.coarseBins != 0 || header.count < 0) {
+			file.close();
+			return false;
+		}
+
+		nBins= header.nBins;
+		coarseBins= header.coarseBins;
+
+		// the count of a corrupted file must not overflow the size computation
+		size_t entryBytes= static_cast<size_t>(fineLength() + coarseLength())*sizeof(float);
+		if (static_cast<unsigned long long>(header.count) > static_cast<size_t>(end - p)/entryBytes) {
+			file.close();
+			return false;
+		}
+		size_t count= static_cast<size_t>(header.count);
+
+		// histograms are used directly from the mapped memory
+		size_t histBytes= count*entryBytes;
+		fine= reinterpret_cast<const float*>(p);
+		coarse= fine + count*fineLength();
+		p+= histBytes;
+
+		// read the image names
+		names.reserve(count);
+		while (names.size() < count && p < end) {
+
+			const char* e= static_cast<const char*>(memchr(p, 0, end - p));
+			if (!e) break;
+			names.push_back(std::string(p, e));
+			p= e + 1;
+		}
+
+		if (names.size() != count) {
+			names.clear();
+			file.close();
+			attach();
+			return false;
+		}
+
+		return true;
+	}
+
+	// returns the k most similar images (index, score) sorted from best to worst
+	std::vector<std::pair<int, double> > query(const cv::Mat& image, int k) {
+
+		std::vector<std::pair<int, double> > results;
+		int n= size();
+		if (n == 0 || k <= 0)
+			return results;
+
+		cv::Mat h= getHistogram(image);
+		cv::Mat c= getCoarseHistogram(h);
+		// 1-row view of the full query histogram
+		cv::Mat q(1, fineLength(), CV_32F, h.ptr<float>());
+
+		// rows to be fully compared
+		std::vector<int> candidates;
+		int nc= std::max(nCandidates, k);
+
+		if (nCandidates > 0 && nc < n) {
+
+			// coarse scores of all images
+			std::vector<double> coarseScores(n);
+			cv::parallel_for_(cv::Range(0, n),
+				HistogramScorer(coarse, coarseLength(), 0, c, method, coarseScores));
+
+			// keep the nc best candidates
+			candidates.resize(n);
+			for (int i= 0; i < n; i++)
+				candidates[i]= i;
+
+			bool higher= higherIsBetter(method);
+			std::nth_element(candidates.begin(), candidates.begin() + nc, candidates.end(),
+				[&coarseScores, higher](int a, int b) {
+					return higher ? coarseScores[a] > coarseScores[b] : coarseScores[a] < coarseScores[b]; });
+			candidates.resize(nc);
+
+		} else {
+
+			candidates.resize(n);
+			for (int i= 0; i < n; i++)
+				candidates[i]= i;
+		}
+
+		// full scores of the candidates
+		std::vector<double> scores(candidates.size());
+		cv::parallel_for_(cv::Range(0, static_cast<int>(candidates.size())),
+			HistogramScorer(fine, fineLength(), &candidates, q, method, scores));
+
+		for (size_t i= 0; i < candidates.size(); i++)
+			results.push_back(std::make_pair(candidates[i], scores[i]));
+
+		// keep the k best
+		k= std::min(k, static_cast<int>(results.size()));
+		bool higher= higherIsBetter(method);
+		std::partial_sort(results.begin(), results.begin() + k, results.end(),
+			[higher](const std::pair<int, double>& a, const std::pair<int, double>& b) {
+				return higher ? a.second > b.second : a.second < b.second; });
+		results.resize(k);
+
+		return results;
+	}
+};
+
+#endif
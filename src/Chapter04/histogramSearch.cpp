@@ -0,0 +1,84 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 4 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+#include <iostream>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/highgui.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "histogram.h"
+#include "histogramSearch.h"
+
+int main()
+{
+	// Open image
+	cv::Mat image= cv::imread("bike55.bmp",0);
+	if (!image.data)
+		return 0; 
+
+	// define image roi
+	int xo=97, yo=112;
+	int width=25, height=30;
+	cv::Mat roi(image,cv::Rect(xo,yo,width,height));
+
+	// histogram of 16 bins
+	Histogram1D h;
+	h.setNBins(16);
+	// compute histogram over image roi 
+	cv::Mat refHistogram= h.getHistogram(roi);
+
+	// search in second image
+	cv::Mat secondImage= cv::imread("bike65.bmp",0);
+	if (!secondImage.data)
+		return 0; 
+
+	HistogramSearch<16> search;
+	search.setImage(secondImage);
+	search.setReference(refHistogram);
+	search.setComparisonMethod(cv::HISTCMP_INTERSECT);
+
+	// the windows sizes to be tested
+	std::vector<cv::Size> sizes;
+	sizes.push_back(cv::Size(20,24));
+	sizes.push_back(cv::Size(width,height));
+	sizes.push_back(cv::Size(30,36));
+
+	// find the 3 best windows over the whole image
+	int64 time= cv::getTickCount();
+	std::vector<WindowMatch> matches= search.search(sizes,3);
+	time= cv::getTickCount()-time;
+	std::cout << "time= " << 1000.*time/cv::getTickFrequency() << "ms" << std::endl;
+
+	for (size_t i=0; i<matches.size(); i++) {
+
+		std::cout << "Match " << i << " = " << matches[i].window << " : " << matches[i].score << std::endl;
+		// draw rectangle at match location (best is black)
+		cv::rectangle(secondImage,matches[i].window,i==0 ? 0 : 255);
+	}
+
+	// draw a rectangle around target object
+	cv::rectangle(image,cv::Rect(xo,yo,width,height),0);
+	cv::namedWindow("Initial Image");
+	cv::imshow("Initial Image",image);
+
+	cv::namedWindow("Best matches");
+	cv::imshow("Best matches",secondImage);
+
+	cv::waitKey();
+}
@@ -0,0 +1,248 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 4 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#if !defined HSEARCH
+#define HSEARCH
+
+#include <vector>
+#include <queue>
+#include <algorithm>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "histogram.h"
+#include "integral.h"
+
+// A window found by the search and its similarity score
+struct WindowMatch {
+
+	cv::Rect window;
+	double score;
+};
+
+// Scores all the windows of a given size, in parallel row stripes.
+// Window histograms are read from the integral histogram
+// and normalized by the window area.
+template <typename T, int N>
+class WindowScorer : public cv::ParallelLoopBody {
+
+	const cv::Mat& integral;   // (rows+1)x(cols+1) N-channel integral image
+	cv::Size size;             // window size
+	const float* reference;    // normalized reference histogram
+	int method;                // cv::HISTCMP_* method
+	cv::Mat& scores;           // one score per window position
+
+  public:
+
+	WindowScorer(const cv::Mat& integral, cv::Size size, const float* reference,
+		         int method, cv::Mat& scores)
+		: integral(integral), size(size), reference(reference), method(method), scores(scores) {}
+
+	void operator()(const cv::Range& range) const {
+
+		float h[N];
+		float norm= 1.0f/(size.width*size.height);
+		cv::Mat ref(1, N, CV_32F, const_cast<float*>(reference));
+		cv::Mat hist(1, N, CV_32F, h);
+
+		for (int y= range.start; y < range.end; y++) {
+
+			const T* top= integral.ptr<T>(y);
+			const T* bottom= integral.ptr<T>(y + size.height);
+			float* out= scores.ptr<float>(y);
+
+			for (int x= 0; x < scores.cols; x++) {
+
+				const T* a= top + x*N;
+				const T* b= top + (x + size.width)*N;
+				const T* c= bottom + x*N;
+				const T* d= bottom + (x + size.width)*N;
+
+				// type T arithmetic, 16-bit sums wrap around
+				for (int n= 0; n < N; n++)
+					h[n]= static_cast<T>(d[n] - c[n] - b[n] + a[n])*norm;
+
+				if (method == cv::HISTCMP_INTERSECT) {
+
+					float s= 0.0f;
+					for (int n= 0; n < N; n++)
+						s+= std::min(h[n], reference[n]);
+					out[x]= s;
+
+				} else {
+
+					out[x]= static_cast<float>(cv::compareHist(ref, hist, method));
+				}
+			}
+		}
+	}
+};
+
+// Searches an image for the windows whose histogram of N bins
+// is the most similar to a reference histogram.
+// All windows of each requested size are scored using an integral histogram.
+// N must be a power of 2.
+template <int N>
+class HistogramSearch {
+
+	cv::Mat planes;      // N binary planes of the image
+	cv::Ptr<IntegralImage<ushort,N> > integral16; // when window areas are below 65536
+	cv::Ptr<IntegralImage<int,N> > integral32;    // otherwise
+	float reference[N];  // normalized reference histogram
+	int method;          // histogram comparison method
+
+	// computes the score of each position of a window of the given size
+	void scoreWindows(cv::Size size, cv::Mat& scores) {
+
+		scores.create(planes.rows - size.height + 1, planes.cols - size.width + 1, CV_32F);
+
+		// 16-bit sums are exact for windows of less than 65536 pixels
+		// and halve the memory read
+		if (size.area() < 65536) {
+
+			if (!integral16)
+				integral16= cv::makePtr<IntegralImage<ushort,N> >(planes);
+			cv::parallel_for_(cv::Range(0, scores.rows),
+				WindowScorer<ushort,N>(integral16->getIntegralImage(), size, reference, method, scores));
+
+		} else {
+
+			if (!integral32)
+				integral32= cv::makePtr<IntegralImage<int,N> >(planes);
+			cv::parallel_for_(cv::Range(0, scores.rows),
+				WindowScorer<int,N>(integral32->getIntegralImage(), size, reference, method, scores));
+		}
+	}
+
+  public:
+
+	HistogramSearch() : method(cv::HISTCMP_INTERSECT) {
+
+		std::fill(reference, reference + N, 0.0f);
+	}
+
+	// Sets the gray-level image to be searched
+	void setImage(const cv::Mat& image) {
+
+		convertToBinaryPlanes(image, planes, N);
+		integral16.release();
+		integral32.release();
+	}
+
+	// Sets the reference histogram of N bins
+	// e.g. as computed by Histogram1D
+	void setReference(const cv::Mat& hist) {
+
+		CV_Assert(hist.total() == N && hist.type() == CV_32F);
+
+		cv::Mat ref(1, N, CV_32F, reference);
+		cv::normalize(hist.reshape(1, 1), ref, 1.0, 0.0, cv::NORM_L1);
+	}
+
+	// Sets the histogram comparison method (cv::HISTCMP_*)
+	void setComparisonMethod(int m) {
+
+		method= m;
+	}
+
+	int getComparisonMethod() {
+
+		return method;
+	}
+
+	// Returns the map of the scores of all positions of a window size
+	cv::Mat getScores(cv::Size size) {
+
+		cv::Mat scores;
+		if (size.width <= planes.cols && size.height <= planes.rows)
+			scoreWindows(size, scores);
+
+		return scores;
+	}
+
+	// Returns the k best windows over all the window sizes, best first.
+	// Only the local maxima of each score map are retained
+	// such that the matches do not pile up around the best position.
+	std::vector<WindowMatch> search(const std::vector<cv::Size>& sizes, int k) {
+
+		bool higher= higherIsBetter(method);
+		// worst retained match on top
+		auto better= [higher](const WindowMatch& a, const WindowMatch& b) {
+			return higher ? a.score > b.score : a.score < b.score; };
+		std::priority_queue<WindowMatch, std::vector<WindowMatch>, decltype(better)> best(better);
+
+		cv::Mat scores;
+		for (size_t s= 0; s < sizes.size(); s++) {
+
+			if (sizes[s].width > planes.cols || sizes[s].height > planes.rows)
+				continue;
+
+			scoreWindows(sizes[s], scores);
+			if (!higher) // local maxima are searched
+				scores= -scores;
+
+			for (int y= 0; y < scores.rows; y++) {
+
+				const float* previous= scores.ptr<float>(std::max(y - 1, 0));
+				const float* current= scores.ptr<float>(y);
+				const float* next= scores.ptr<float>(std::min(y + 1, scores.rows - 1));
+
+				for (int x= 0; x < scores.cols; x++) {
+
+					float v= current[x];
+					int x0= std::max(x - 1, 0);
+					int x1= std::min(x + 1, scores.cols - 1);
+
+					// is it a local maximum?
+					// ties are broken as in cv::HoughLines: strictly greater than the
+					// neighbours already visited, at least equal to the ones that follow,
+					// such that two adjacent windows of equal score are never both retained
+					// (a plateau of irregular shape can still give several matches)
+					if ((y > 0 && (v <= previous[x0] || v <= previous[x] || v <= previous[x1])) ||
+						(x > 0 && v <= current[x0]) || v < current[x1] ||
+						v < next[x0] || v < next[x] || v < next[x1])
+						continue;
+
+					WindowMatch m;
+					m.window= cv::Rect(x, y, sizes[s].width, sizes[s].height);
+					m.score= higher ? v : -v;
+
+					if (static_cast<int>(best.size()) < k) {
+						best.push(m);
+					} else if (k > 0 && better(m, best.top())) {
+						best.pop();
+						best.push(m);
+					}
+				}
+			}
+		}
+
+		// sort from best to worst
+		std::vector<WindowMatch> matches(best.size());
+		for (int i= static_cast<int>(matches.size()) - 1; i >= 0; i--) {
+
+			matches[i]= best.top();
+			best.pop();
+		}
+
+		return matches;
+	}
+};
+
+#endif
@@ -22,16 +22,138 @@ Copyright (C) 2016 Robert Laganiere, www.laganiere.name
 #include <opencv2\imgproc\imgproc.hpp>
 #include "colorhistogram.h"
 
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <functional>
+
+// Intersection of a query histogram with reference histograms
+// stored as the rows of a matrix, in parallel stripes of references.
+// Only the non-empty bins of the query are visited, the largest first.
+// When k > 0, each stripe keeps its k best references and abandons a reference
+// as soon as the remaining query bins cannot make it better than its k-th best.
+class BatchIntersection : public cv::ParallelLoopBody {
+
+	typedef std::pair<double,int> Score; // (intersection, reference)
+
+	const cv::Mat& references;  // one CV_32F histogram per row
+	const std::vector<int>& bins;         // non-empty query bins
+	const std::vector<float>& values;     // their values, in decreasing order
+	const std::vector<double>& remaining; // sum of the values from each position to the end
+	int k;                                // 0 to score all references
+	int nStripes;
+	std::vector<std::vector<Score> >& results;  // scores of each stripe
+
+  public:
+
+	BatchIntersection(const cv::Mat& references, const std::vector<int>& bins,
+		              const std::vector<float>& values, const std::vector<double>& remaining,
+		              int k, int nStripes, std::vector<std::vector<Score> >& results)
+		: references(references), bins(bins), values(values), remaining(remaining),
+		  k(k), nStripes(nStripes), results(results) {}
+
+	// processes the stripes in range
+	void operator()(const cv::Range& range) const {
+
+		int n= static_cast<int>(bins.size());
+		const int* b= bins.empty() ? 0 : &bins[0];
+		const float* q= values.empty() ? 0 : &values[0];
+
+		for (int s= range.start; s < range.end; s++) {
+
+			int first= static_cast<int>(static_cast<long long>(references.rows)*s/nStripes);
+			int last= static_cast<int>(static_cast<long long>(references.rows)*(s+1)/nStripes);
+
+			// worst retained score on top
+			std::priority_queue<Score, std::vector<Score>, std::greater<Score> > best;
+			std::vector<Score>& scores= results[s];
+			scores.clear();
+
+			for (int r= first; r < last; r++) {
+
+				const float* h= references.ptr<float>(r);
+				// score to beat
+				double threshold= (k > 0 && static_cast<int>(best.size()) == k) ? best.top().first : -1.0;
+
+				double sum= 0.0;
+				int m= 0;
+				while (m < n) {
+
+					// blocks of 16 bins between the checks
+					int end= std::min(m + 16, n);
+					for (; m < end; m++)
+						sum+= std::min(q[m], h[b[m]]);
+
+					if (sum + remaining[m] <= threshold)
+						break; // cannot be among the k best
+				}
+
+				if (k == 0) {
+
+					scores.push_back(Score(sum, r));
+
+				} else if (m == n && sum > threshold) {
+
+					if (static_cast<int>(best.size()) == k)
+						best.pop();
+					best.push(Score(sum, r));
+				}
+			}
+
+			for (; !best.empty(); best.pop())
+				scores.push_back(best.top());
+		}
+	}
+};
+
 class ImageComparator {
 
   private:
 
 	cv::Mat refH;       // reference histogram
 	cv::Mat inputH;     // histogram of input image
+	cv::Mat refHs;      // reference histograms of the batch mode, one per row
 
 	ColorHistogram hist; 
 	int nBins; // number of bins used in each color channel
 
+	// scores the query histogram against all the batch references
+	// k= 0 for all scores, otherwise only the k best are returned
+	std::vector<std::pair<double,int> > batchIntersect(const cv::Mat& image, int k) {
+
+		inputH= hist.getHistogram(image);
+
+		// non-empty bins of the query, largest first
+		std::vector<std::pair<double,int> > nonEmpty;
+		const float* h= inputH.ptr<float>();
+		for (int i= 0; i < static_cast<int>(inputH.total()); i++)
+			if (h[i] > 0.0f)
+				nonEmpty.push_back(std::make_pair(h[i], i));
+		std::sort(nonEmpty.begin(), nonEmpty.end(), std::greater<std::pair<double,int> >());
+
+		std::vector<int> bins(nonEmpty.size());
+		std::vector<float> values(nonEmpty.size());
+		std::vector<double> remaining(nonEmpty.size() + 1, 0.0);
+		for (int i= static_cast<int>(nonEmpty.size()) - 1; i >= 0; i--) {
+
+			bins[i]= nonEmpty[i].second;
+			values[i]= static_cast<float>(nonEmpty[i].first);
+			remaining[i]= remaining[i+1] + values[i];
+		}
+
+		// several stripes per thread to balance the load
+		int nStripes= std::max(std::min(refHs.rows, 4*cv::getNumThreads()), 1);
+		std::vector<std::vector<std::pair<double,int> > > results(nStripes);
+		cv::parallel_for_(cv::Range(0, nStripes),
+			BatchIntersection(refHs, bins, values, remaining, k, nStripes, results));
+
+		std::vector<std::pair<double,int> > scores;
+		for (int s= 0; s < nStripes; s++)
+			scores.insert(scores.end(), results[s].begin(), results[s].end());
+
+		return scores;
+	}
+
   public:
 
 	ImageComparator() :nBins(8) {
@@ -64,6 +186,52 @@ class ImageComparator {
 		// histogram comparison using intersection
 		return cv::compareHist(refH,inputH, cv::HISTCMP_INTERSECT);
 	}
+
+	// set and compute the histograms of a batch of reference images
+	// they are stored contiguously, one histogram per row
+	void setReferenceImages(const std::vector<cv::Mat>& images) {
+
+		hist.setSize(nBins);
+		refHs.create(static_cast<int>(images.size()), nBins*nBins*nBins, CV_32F);
+
+		for (int i= 0; i < refHs.rows; i++) {
+
+			cv::Mat h= hist.getHistogram(images[i]);
+			std::copy(h.ptr<float>(), h.ptr<float>() + refHs.cols, refHs.ptr<float>(i));
+		}
+	}
+
+	// compare an image with all the batch references
+	// the query histogram is computed once
+	// same scores as compare() with each reference
+	std::vector<double> compareAll(const cv::Mat& image) {
+
+		std::vector<std::pair<double,int> > results= batchIntersect(image, 0);
+
+		std::vector<double> scores(refHs.rows);
+		for (size_t i= 0; i < results.size(); i++)
+			scores[results[i].second]= results[i].first;
+
+		return scores;
+	}
+
+	// find the k batch references most similar to an image
+	// returns the pairs (reference index, intersection), best first
+	std::vector<std::pair<int,double> > findBest(const cv::Mat& image, int k) {
+
+		std::vector<std::pair<double,int> > results= batchIntersect(image, std::max(k, 1));
+
+		// merge the k best of each stripe
+		std::sort(results.begin(), results.end(), std::greater<std::pair<double,int> >());
+		if (static_cast<int>(results.size()) > k)
+			results.resize(std::max(k, 0));
+
+		std::vector<std::pair<int,double> > best(results.size());
+		for (size_t i= 0; i < results.size(); i++)
+			best[i]= std::make_pair(results[i].second, results[i].first);
+
+		return best;
+	}
 };
 
 
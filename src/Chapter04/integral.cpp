@@ -22,6 +22,7 @@ Copyright (C) 2016 Robert Laganiere, www.laganiere.name
 #include <opencv2/imgproc/imgproc.hpp>
 
 #include "integral.h"
+#include "adaptiveThreshold.h"
 
 int main()
 {
@@ -138,6 +139,60 @@ int main()
 	cv::namedWindow("Adaptive Threshold (integral)");
 	cv::imshow("Adaptive Threshold (integral)",binary);
 
+	// adaptive threshold using the sums of all windows computed at once
+	time= cv::getTickCount();
+	cv::Mat binaryBatch(image.size(),CV_8U,cv::Scalar(255)); // white border
+	cv::Mat sums;
+	integral.sums(cv::Size(blockSize,blockSize),cv::Size(1,1),sums);
+
+	for (int j = 0; j<sums.rows; j++) {
+
+		// window sums of row j+halfSize
+		const int* s = sums.ptr<int>(j);
+		const uchar* in = image.ptr<uchar>(j + halfSize) + halfSize;
+		uchar* out = binaryBatch.ptr<uchar>(j + halfSize) + halfSize;
+
+		for (int i = 0; i<sums.cols; i++) {
+
+			// apply adaptive threshold
+			out[i] = in[i] < (s[i] / (blockSize*blockSize) - threshold) ? 0 : 255;
+		}
+	}
+
+	time= cv::getTickCount()-time;
+	std::cout << "time integral (batch)= " << time << std::endl; 
+
+	cv::namedWindow("Adaptive Threshold (batch)");
+	cv::imshow("Adaptive Threshold (batch)",binaryBatch);
+
+	// adaptive threshold computed in parallel bands
+	// without storing the full integral image
+	AdaptiveThresholder thresholder;
+	thresholder.setBlockSize(blockSize);
+	thresholder.setThreshold(threshold);
+	cv::Mat binaryBands;
+
+	time= cv::getTickCount();
+	thresholder.apply(image,binaryBands);
+	time= cv::getTickCount()-time;
+	std::cout << "time integral (bands)= " << time << std::endl; 
+	std::cout << "integral image memory: full= " << iimage.total()*iimage.elemSize()
+		      << " bytes, per band= " << thresholder.bufferSize(image.cols) << " bytes" << std::endl;
+	std::cout << "pixels different from adaptiveThreshold= " 
+		      << cv::countNonZero(binaryBands != binaryAdaptive) << std::endl;
+
+	cv::namedWindow("Adaptive Threshold (bands)");
+	cv::imshow("Adaptive Threshold (bands)",binaryBands);
+
+	// Haar-like feature: difference between two adjacent windows
+	std::vector<cv::Rect> windows;
+	windows.push_back(cv::Rect(18,45,15,50));
+	windows.push_back(cv::Rect(33,45,15,50));
+	std::vector<cv::Vec<int,1> > haarSums;
+	integral.sums(windows,haarSums);
+	std::cout << "sum (batch)=" << haarSums[0][0]+haarSums[1][0] << std::endl;
+	std::cout << "Haar-like feature=" << haarSums[0][0]-haarSums[1][0] << std::endl;
+
 	// adaptive threshold using image operators
 	time= cv::getTickCount();
 	cv::Mat filtered;
@@ -22,40 +22,177 @@ Copyright (C) 2016 Robert Laganiere, www.laganiere.name
 #include <opencv2/core.hpp>
 #include <opencv2/highgui.hpp>
 #include <opencv2/imgproc.hpp>
+#include <opencv2/core/hal/intrin.hpp>
 
 #include <vector>
+#include <algorithm>
+
+// Computes out[i]= d[i]-c[i]-b[i]+a[i] over n consecutive elements,
+// a, b, c and d pointing to the 4 corners of a window in the integral image.
+// The n elements are the N channels of one window, or the N channels
+// of n/N horizontally consecutive windows.
+template <typename T>
+inline void windowSums(const T* a, const T* b, const T* c, const T* d, T* out, int n) {
+
+	for (int i=0; i<n; i++)
+		out[i]= static_cast<T>(d[i]-c[i]-b[i]+a[i]);
+}
+
+// the integral of a large image can exceed the int range:
+// the sums are computed modulo 2^32, the window sum itself being always representable
+template <>
+inline void windowSums<int>(const int* a, const int* b, const int* c, const int* d, int* out, int n) {
+
+	int i=0;
+#if CV_SIMD128
+	for (; i<=n-4; i+=4)
+		cv::v_store(out+i, cv::v_load(d+i) - cv::v_load(c+i) - cv::v_load(b+i) + cv::v_load(a+i));
+#endif
+	for (; i<n; i++)
+		out[i]= static_cast<int>(static_cast<unsigned>(d[i])-c[i]-b[i]+a[i]);
+}
+
+#if CV_SIMD128
+template <>
+inline void windowSums<ushort>(const ushort* a, const ushort* b, const ushort* c, const ushort* d, ushort* out, int n) {
+
+	// wrap-around (not saturated) 16-bit arithmetic
+	int i=0;
+	for (; i<=n-8; i+=8)
+		cv::v_store(out+i, cv::v_add_wrap(cv::v_sub_wrap(cv::v_sub_wrap(cv::v_load(d+i), cv::v_load(c+i)),
+		                                                 cv::v_load(b+i)), cv::v_load(a+i)));
+	for (; i<n; i++)
+		out[i]= static_cast<ushort>(d[i]-c[i]-b[i]+a[i]);
+}
+
+template <>
+inline void windowSums<float>(const float* a, const float* b, const float* c, const float* d, float* out, int n) {
+
+	int i=0;
+	for (; i<=n-4; i+=4)
+		cv::v_store(out+i, cv::v_load(d+i) - cv::v_load(c+i) - cv::v_load(b+i) + cv::v_load(a+i));
+	for (; i<n; i++)
+		out[i]= d[i]-c[i]-b[i]+a[i];
+}
+#endif
 
 template <typename T, int N>
 class IntegralImage {
 
 	  cv::Mat integralImage;
 
+	  // sum over the window [x0,x1[ x [y0,y1[
+	  // computed in type T such that 16-bit sums can wrap around
+	  cv::Vec<T,N> sum(int x0, int y0, int x1, int y1) {
+
+		  const T* a= integralImage.ptr<T>(y0) + x0*N;
+		  const T* b= integralImage.ptr<T>(y0) + x1*N;
+		  const T* c= integralImage.ptr<T>(y1) + x0*N;
+		  const T* d= integralImage.ptr<T>(y1) + x1*N;
+
+		  cv::Vec<T,N> s;
+		  for (int n=0; n<N; n++)
+			  s[n]= static_cast<T>(d[n]-c[n]-b[n]+a[n]);
+
+		  return s;
+	  }
+
   public:
 
 	  IntegralImage(cv::Mat image) {
 
-		// (costly) computation of the integral image
-		cv::integral(image,integralImage,cv::DataType<T>::type);
+		if (cv::DataType<T>::depth == CV_16U) {
+
+			// 16-bit integral computed modulo 2^16:
+			// window sums remain exact as long as they are below 65536
+			cv::Mat sums;
+			cv::integral(image,sums,CV_32S);
+			sums= sums.reshape(1) & cv::Scalar(0xFFFF);
+			sums.reshape(N).convertTo(integralImage,CV_16U);
+
+		} else {
+
+			// (costly) computation of the integral image
+			cv::integral(image,integralImage,cv::DataType<T>::type);
+		}
+	  }
+
+	  // the (rows+1)x(cols+1) integral image
+	  const cv::Mat& getIntegralImage() const {
+
+		  return integralImage;
 	  }
 
 	  // compute sum over sub-regions of any size from 4 pixel access
 	  cv::Vec<T,N> operator()(int xo, int yo, int width, int height) {
 
 		  // window at (xo,yo) of size width by height
-          return (integralImage.at<cv::Vec<T,N> >(yo+height,xo+width)
-                  -integralImage.at<cv::Vec<T,N> >(yo+height,xo)
-                  -integralImage.at<cv::Vec<T,N> >(yo,xo+width)
-                  +integralImage.at<cv::Vec<T,N> >(yo,xo));
+		  return sum(xo,yo,xo+width,yo+height);
 	  }
 
 	  // compute sum over sub-regions of any size from 4 pixel access
 	  cv::Vec<T,N> operator()(int x, int y, int radius) {
 
 		  // square window centered at (x,y) of size 2*radius+1
-          return (integralImage.at<cv::Vec<T,N> >(y+radius+1,x+radius+1)
-                  -integralImage.at<cv::Vec<T,N> >(y+radius+1,x-radius)
-                  -integralImage.at<cv::Vec<T,N> >(y-radius,x+radius+1)
-                  +integralImage.at<cv::Vec<T,N> >(y-radius,x-radius));
+		  return sum(x-radius,y-radius,x+radius+1,y+radius+1);
+	  }
+
+	  // compute the sums over a list of windows
+	  void sums(const std::vector<cv::Rect>& windows, std::vector<cv::Vec<T,N> >& result) const {
+
+		  result.resize(windows.size());
+		  for (size_t k=0; k<windows.size(); k++) {
+
+			  const cv::Rect& r= windows[k];
+			  const T* top= integralImage.ptr<T>(r.y);
+			  const T* bottom= integralImage.ptr<T>(r.y+r.height);
+
+			  // the N channels are processed together
+			  windowSums(top+r.x*N, top+(r.x+r.width)*N,
+				         bottom+r.x*N, bottom+(r.x+r.width)*N, result[k].val, N);
+		  }
+	  }
+
+	  // compute the sums over a regular grid of windows of the given size
+	  // window (i,j) has its top-left corner at (i*step.width, j*step.height)
+	  // the result has one N-channel element of type T per window
+	  // with a unit step, this is a box filter of the image without its borders
+	  void sums(cv::Size window, cv::Size step, cv::Mat& result) const {
+
+		  CV_Assert(step.width > 0 && step.height > 0);
+
+		  // no window fits in the image
+		  // (the division below would round a negative count up to 1)
+		  if (window.width > integralImage.cols-1 || window.height > integralImage.rows-1) {
+
+			  result.release();
+			  return;
+		  }
+
+		  int nx= (integralImage.cols-1-window.width)/step.width + 1;
+		  int ny= (integralImage.rows-1-window.height)/step.height + 1;
+
+		  result.create(ny, nx, integralImage.type());
+		  int w= window.width*N;
+
+		  for (int j=0; j<ny; j++) {
+
+			  const T* top= integralImage.ptr<T>(j*step.height);
+			  const T* bottom= integralImage.ptr<T>(j*step.height+window.height);
+			  T* out= result.ptr<T>(j);
+
+			  if (step.width == 1) {
+
+				  // the windows of a row are consecutive:
+				  // the whole row is computed at once
+				  windowSums(top, top+w, bottom, bottom+w, out, nx*N);
+
+			  } else {
+
+				  for (int i=0, x=0; i<nx; i++, x+=step.width*N, out+=N)
+					  windowSums(top+x, top+x+w, bottom+x, bottom+x+w, out, N);
+			  }
+		  }
 	  }
 };
 
@@ -84,4 +221,182 @@ void convertToBinaryPlanes(const cv::Mat& input, cv::Mat& output, int nPlanes) {
 		cv::merge(planes,output);
 }
 
+// Computes the tile-local cumulative counts of the rows of tile bands
+template <int N>
+class IntegralHistogramBuilder : public cv::ParallelLoopBody {
+
+	const cv::Mat& image;
+	const uchar* bins;   // bin of each gray level
+	int tileSize;
+	cv::Mat& local;      // CV_16UC(N) output
+
+  public:
+
+	IntegralHistogramBuilder(const cv::Mat& image, const uchar* bins, int tileSize, cv::Mat& local)
+		: image(image), bins(bins), tileSize(tileSize), local(local) {}
+
+	// processes the bands of tiles in range
+	void operator()(const cv::Range& range) const {
+
+		for (int ty= range.start; ty < range.end; ty++) {
+
+			int y0= ty*tileSize;
+			int y1= std::min(y0 + tileSize, image.rows);
+
+			for (int j= y0; j < y1; j++) {
+
+				const uchar* data= image.ptr<uchar>(j);
+				ushort* out= local.ptr<ushort>(j);
+				const ushort* above= j > y0 ? local.ptr<ushort>(j-1) : 0;
+
+				for (int x0= 0; x0 < image.cols; x0+= tileSize) {
+
+					int x1= std::min(x0 + tileSize, image.cols);
+					// counts of the current tile row
+					ushort row[N]= { 0 };
+
+					for (int i= x0; i < x1; i++) {
+
+						row[bins[data[i]]]++;
+						ushort* o= out + i*N;
+
+						if (above) {
+							const ushort* a= above + i*N;
+							for (int n= 0; n < N; n++)
+								o[n]= a[n] + row[n];
+						} else {
+							for (int n= 0; n < N; n++)
+								o[n]= row[n];
+						}
+					}
+				}
+			}
+		}
+	}
+};
+
+// Integral histogram of N bins computed directly from a gray-level image
+// in a single pass, without building N binary planes.
+// The image is divided into tiles: inside a tile, the cumulative counts
+// from the tile origin are stored on 16 bits; the integral values along
+// the tile borders are stored on 32 bits. This is about half the memory
+// of a 32-bit integral image, and a few times less than the binary planes
+// and the float integral image of convertToBinaryPlanes.
+template <int N>
+class IntegralHistogram {
+
+	int tileSize;           // tiles are tileSize x tileSize
+	uchar bins[256];        // bin of each gray level
+	cv::Mat local;          // rows x cols CV_16UC(N), counts from the tile origin (inclusive)
+	cv::Mat rowBorders;     // nTilesY x (cols+1) CV_32SC(N), integral along rows y= ty*tileSize
+	cv::Mat colBorders;     // nTilesX x (rows+1) CV_32SC(N), integral along columns x= tx*tileSize
+
+	// adds sign times the integral value at (x,y)
+	void addIntegral(int x, int y, int sign, int* sum) const {
+
+		if (x == 0 || y == 0)
+			return;
+
+		// tile containing pixel (x-1,y-1)
+		int tx= (x-1)/tileSize;
+		int ty= (y-1)/tileSize;
+		int x0= tx*tileSize;
+		int y0= ty*tileSize;
+
+		const int* c= colBorders.ptr<int>(tx) + y*N;   // I(x0,y)
+		const int* c0= colBorders.ptr<int>(tx) + y0*N; // I(x0,y0)
+		const int* r= rowBorders.ptr<int>(ty) + x*N;   // I(x,y0)
+		const ushort* l= local.ptr<ushort>(y-1) + (x-1)*N;
+
+		for (int n= 0; n < N; n++)
+			sum[n]+= sign*(c[n] + r[n] - c0[n] + l[n]);
+	}
+
+  public:
+
+	// tileSize*tileSize must be less than 65536
+	IntegralHistogram(const cv::Mat& image, int tileSize= 128) : tileSize(tileSize) {
+
+		CV_Assert(image.type() == CV_8U && tileSize > 0 && tileSize*tileSize < 65536);
+
+		// uniform bins over [0,256[
+		for (int v= 0; v < 256; v++)
+			bins[v]= static_cast<uchar>(v*N/256);
+
+		int nTilesX= (image.cols + tileSize - 1)/tileSize;
+		int nTilesY= (image.rows + tileSize - 1)/tileSize;
+
+		// tile-local counts, each band of tiles in parallel
+		local.create(image.rows, image.cols, CV_16UC(N));
+		cv::parallel_for_(cv::Range(0, nTilesY),
+			IntegralHistogramBuilder<N>(image, bins, tileSize, local));
+
+		// integral along the horizontal tile borders
+		rowBorders= cv::Mat::zeros(nTilesY, image.cols + 1, CV_32SC(N));
+		for (int ty= 1; ty < nTilesY; ty++) {
+
+			const int* previous= rowBorders.ptr<int>(ty-1);
+			int* current= rowBorders.ptr<int>(ty);
+			// last row of the band above
+			const ushort* last= local.ptr<ushort>(ty*tileSize - 1);
+			// counts of the complete tiles on the left
+			int acc[N]= { 0 };
+
+			for (int x= 1; x <= image.cols; x++) {
+
+				const ushort* l= last + (x-1)*N;
+				for (int n= 0; n < N; n++)
+					current[x*N + n]= previous[x*N + n] + acc[n] + l[n];
+
+				if (x%tileSize == 0) // end of a tile
+					for (int n= 0; n < N; n++)
+						acc[n]+= l[n];
+			}
+		}
+
+		// integral along the vertical tile borders
+		colBorders= cv::Mat::zeros(nTilesX, image.rows + 1, CV_32SC(N));
+		for (int tx= 1; tx < nTilesX; tx++) {
+
+			const int* previous= colBorders.ptr<int>(tx-1);
+			int* current= colBorders.ptr<int>(tx);
+			// last column of the tiles on the left
+			int xl= tx*tileSize - 1;
+			// counts of the complete tiles above
+			int acc[N]= { 0 };
+
+			for (int y= 1; y <= image.rows; y++) {
+
+				const ushort* l= local.ptr<ushort>(y-1) + xl*N;
+				for (int n= 0; n < N; n++)
+					current[y*N + n]= previous[y*N + n] + acc[n] + l[n];
+
+				if (y%tileSize == 0) // end of a tile
+					for (int n= 0; n < N; n++)
+						acc[n]+= l[n];
+			}
+		}
+	}
+
+	// number of bytes used by the integral histogram
+	size_t memorySize() const {
+
+		return local.total()*local.elemSize() + rowBorders.total()*rowBorders.elemSize()
+			+ colBorders.total()*colBorders.elemSize();
+	}
+
+	// compute histogram over sub-regions of any size
+	cv::Vec<int,N> operator()(int xo, int yo, int width, int height) const {
+
+		// window at (xo,yo) of size width by height
+		cv::Vec<int,N> sum;
+		addIntegral(xo+width, yo+height, 1, sum.val);
+		addIntegral(xo, yo+height, -1, sum.val);
+		addIntegral(xo+width, yo, -1, sum.val);
+		addIntegral(xo, yo, 1, sum.val);
+
+		return sum;
+	}
+};
+
 #endif
@@ -0,0 +1,191 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 4 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#if !defined MSTRACKER
+#define MSTRACKER
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+
+#include "videoprocessor.h"
+#include "contentFinder.h"
+#include "colorhistogram.h"
+
+// Tracks an object in a video using its hue histogram.
+// The histogram is back projected only inside a search window
+// around the last object position, and mean shift (or CamShift)
+// is applied on this partial back projection.
+class MeanShiftTracker : public FrameProcessor {
+
+	ColorHistogram hc;       // to compute the hue histogram
+	ContentFinder finder;    // to back project it
+	cv::Rect window;         // current object position
+	cv::RotatedRect box;     // oriented object position (CamShift only)
+	bool reset;              // true if the histogram must be computed
+	int minSaturation;       // pixels with lower saturation are ignored
+	double margin;           // search window margin (fraction of the object size)
+	bool adaptScale;         // if true, CamShift is used
+	cv::TermCriteria criteria;
+
+	cv::Mat hsv;             // HSV search region
+	cv::Mat saturation;      // saturation mask of the search region
+	cv::Mat backProjection;  // back projection inside the search region
+
+	double latency;          // processing time of the last frame (ms)
+	double totalLatency;     // accumulated processing time (ms)
+	long nFrames;            // number of tracked frames
+
+  public:
+
+	MeanShiftTracker() : reset(true), minSaturation(65), margin(0.5), adaptScale(false),
+		criteria(cv::TermCriteria::MAX_ITER | cv::TermCriteria::EPS, 10, 1),
+		latency(0.0), totalLatency(0.0), nFrames(0) {
+
+		hc.setSize(180);
+		finder.setThreshold(-1.0f); // no thresholding
+	}
+
+	// set the object position to initiate tracking
+	// the histogram is computed on the next frame
+	void setTarget(const cv::Rect& r) {
+
+		window= r;
+		reset= true;
+	}
+
+	// get the current object position
+	cv::Rect getTarget() {
+
+		return window;
+	}
+
+	// get the oriented object position (when CamShift is used)
+	cv::RotatedRect getOrientedTarget() {
+
+		return box;
+	}
+
+	// set the minimum saturation of the pixels considered
+	void setMinSaturation(int s) {
+
+		minSaturation= s;
+		reset= true;
+	}
+
+	// set the margin added on each side of the object
+	// to define the search window, as a fraction of the object size
+	void setMargin(double m) {
+
+		margin= m;
+	}
+
+	// use CamShift to adapt the window size and orientation
+	void setScaleAdaptation(bool flag) {
+
+		adaptScale= flag;
+	}
+
+	// set the mean shift termination criteria
+	void setTermCriteria(const cv::TermCriteria& c) {
+
+		criteria= c;
+	}
+
+	// processing time of the last frame in ms
+	double getLatency() {
+
+		return latency;
+	}
+
+	// average processing time per frame in ms
+	double getAverageLatency() {
+
+		return nFrames ? totalLatency/nFrames : 0.0;
+	}
+
+	// processing method
+	void process(cv::Mat &frame, cv::Mat &output) {
+
+		int64 time= cv::getTickCount();
+		cv::Rect frameRect(0, 0, frame.cols, frame.rows);
+
+		if (reset) { // new tracking session
+
+			reset= false;
+			window&= frameRect;
+			if (window.area() == 0) {
+
+				frame.copyTo(output);
+				return;
+			}
+
+			// hue histogram of the object
+			finder.setHistogram(hc.getHueHistogram(frame(window), minSaturation));
+
+		} else if (window.area() > 0) { // update the object position
+
+			// search window around the last position
+			int dx= static_cast<int>(margin*window.width);
+			int dy= static_cast<int>(margin*window.height);
+			cv::Rect search(window.x - dx, window.y - dy,
+				            window.width + 2*dx, window.height + 2*dy);
+			search&= frameRect;
+
+			// back projection of the search window only
+			cv::cvtColor(frame(search), hsv, cv::COLOR_BGR2HSV);
+			int ch[3]= { 0, 0, 0 }; // the hue channel
+			backProjection= finder.find(hsv, 0.0f, 180.0f, ch);
+
+			// eliminate pixels with low saturation
+			if (minSaturation > 0) {
+
+				cv::extractChannel(hsv, saturation, 1);
+				cv::threshold(saturation, saturation, minSaturation, 255, cv::THRESH_BINARY);
+				backProjection&= saturation;
+			}
+
+			// search the object in search window coordinates
+			cv::Rect w= window - search.tl();
+			if (adaptScale) {
+
+				box= cv::CamShift(backProjection, w, criteria);
+				box.center+= cv::Point2f(static_cast<float>(search.x), static_cast<float>(search.y));
+
+			} else {
+
+				cv::meanShift(backProjection, w, criteria);
+			}
+
+			window= (w + search.tl()) & frameRect;
+		}
+
+		time= cv::getTickCount() - time;
+		latency= 1000.0*time/cv::getTickFrequency();
+		totalLatency+= latency;
+		nFrames++;
+
+		// draw the object position on current frame
+		frame.copyTo(output);
+		if (adaptScale && box.size.area() > 0)
+			cv::ellipse(output, box, cv::Scalar(0, 255, 0), 2);
+		cv::rectangle(output, window, cv::Scalar(255, 255, 255), 2);
+	}
+};
+
+#endif
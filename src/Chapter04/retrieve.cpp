@@ -16,6 +16,7 @@ and any consequent failure, is purely the responsibility of the user.
 Copyright (C) 2016 Robert Laganiere, www.laganiere.name
 \*------------------------------------------------------------------------------------------*/
 #include <iostream>
+#include <vector>
 using namespace std;
 
 #include <opencv2\core\core.hpp>
@@ -69,6 +70,27 @@ int main()
 	input= cv::imread("fundy.jpg");
 	cout << "waves vs fundy: " << c.compare(input) << endl;
 
+	// batch mode: the reference histograms are computed once
+	// and the query histogram is compared to all of them
+	const char* names[]= { "dog.jpg", "marais.jpg", "bear.jpg", "beach.jpg",
+		                   "polar.jpg", "moose.jpg", "lake.jpg", "fundy.jpg" };
+	std::vector<cv::Mat> references;
+	for (int i=0; i<8; i++)
+		references.push_back(cv::imread(names[i]));
+
+	ImageComparator batch;
+	batch.setReferenceImages(references);
+
+	// all scores
+	std::vector<double> scores= batch.compareAll(image);
+	for (int i=0; i<8; i++)
+		cout << "waves vs " << names[i] << " (batch): " << scores[i] << endl;
+
+	// the 3 best matches only
+	std::vector<std::pair<int,double> > best= batch.findBest(image, 3);
+	for (size_t i=0; i<best.size(); i++)
+		cout << "best match " << i+1 << ": " << names[best[i].first] << " " << best[i].second << endl;
+
 	cv::waitKey();
 	return 0;
 }
\ No newline at end of file
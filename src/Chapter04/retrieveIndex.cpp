@@ -0,0 +1,83 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 4 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include <opencv2/core.hpp>
+#include <opencv2/highgui.hpp>
+
+#include "histogramIndex.h"
+
+int main()
+{
+	// the image collection
+	string files[]= { "dog.jpg", "marais.jpg", "bear.jpg", "beach.jpg",
+		              "polar.jpg", "moose.jpg", "lake.jpg", "fundy.jpg" };
+
+	// Build the index: each histogram is computed only once
+	HistogramIndex index;
+	index.setNumberOfBins(8);
+	for (int i=0; i<8; i++) {
+
+		cv::Mat input= cv::imread(files[i]);
+		if (!input.data)
+			continue;
+		index.add(files[i],input);
+	}
+
+	// Save the index to disk
+	if (!index.save("histograms.idx"))
+		return 0;
+
+	// Reload it (histograms are memory mapped, not read)
+	HistogramIndex retriever;
+	if (!retriever.load("histograms.idx"))
+		return 0;
+	cout << retriever.size() << " images in index" << endl;
+
+	// Read query image
+	cv::Mat image= cv::imread("waves.jpg");
+	if (!image.data)
+		return 0; 
+
+	// Display image
+	cv::namedWindow("Query Image");
+	cv::imshow("Query Image",image);
+
+	// keep the 4 best candidates of the coarse pre-filter
+	retriever.setNumberOfCandidates(4);
+	retriever.setComparisonMethod(cv::HISTCMP_INTERSECT);
+
+	// Retrieve the 3 most similar images
+	int64 time= cv::getTickCount();
+	vector<pair<int,double> > best= retriever.query(image,3);
+	time= cv::getTickCount()-time;
+
+	for (size_t i=0; i<best.size(); i++) {
+
+		cout << "waves vs " << retriever.getName(best[i].first) << ": " << best[i].second << endl;
+		cv::namedWindow(retriever.getName(best[i].first));
+		cv::imshow(retriever.getName(best[i].first),cv::imread(retriever.getName(best[i].first)));
+	}
+	cout << "query time= " << 1000.*time/cv::getTickFrequency() << "ms" << endl;
+
+	cv::waitKey();
+	return 0;
+}
@@ -89,6 +89,14 @@ int main()
 	histogram= intHistogram(135,114,width,height);
 	std::cout<< histogram << std::endl;
 
+	// same histogram from the compact integral histogram
+	// computed without the binary planes
+	IntegralHistogram<16> compactHistogram(secondImage);
+	std::cout<< compactHistogram(135,114,width,height) << std::endl;
+	const cv::Mat& ii= intHistogram.getIntegralImage();
+	std::cout << "memory: " << (planes.total()*planes.elemSize() + ii.total()*ii.elemSize())/1024 << "KB (planes and integral) vs "
+		      << compactHistogram.memorySize()/1024 << "KB (compact)" << std::endl;
+
 	cv::namedWindow("Current Histogram");
 	cv::Mat im2= h.getImageOfHistogram(cv::Mat(histogram),16);
 	cv::imshow("Current Histogram",im2);	
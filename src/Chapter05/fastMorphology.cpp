@@ -0,0 +1,80 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 5 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#include <iostream>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/highgui.hpp>
+
+#include "fastMorphology.h"
+
+int main()
+{
+	// Read input image (gray-level)
+	cv::Mat image= cv::imread("boldt.jpg",0);
+	if (!image.data)
+		return 0; 
+
+	FastMorphology morpho;
+	cv::Mat eroded, fastEroded;
+	int64 time;
+
+	// erosion with square elements of increasing size
+	int sizes[]= { 3, 7, 15, 31, 63 };
+	for (int i=0; i<5; i++) {
+
+		cv::Mat element(sizes[i],sizes[i],CV_8U,cv::Scalar(1));
+
+		time= cv::getTickCount();
+		cv::erode(image,eroded,element);
+		time= cv::getTickCount()-time;
+		std::cout << sizes[i] << "x" << sizes[i] << " erode= " 
+			      << 1000.0*time/cv::getTickFrequency() << "ms";
+
+		morpho.setElementSize(cv::Size(sizes[i],sizes[i]));
+		time= cv::getTickCount();
+		morpho.erode(image,fastEroded);
+		time= cv::getTickCount()-time;
+		std::cout << ", van Herk= " << 1000.0*time/cv::getTickFrequency() << "ms";
+
+		// both results should be identical
+		std::cout << ", different pixels= " << cv::countNonZero(eroded!=fastEroded) << std::endl;
+	}
+
+	// a horizontal line element
+	cv::Mat dilated, fastDilated;
+	cv::dilate(image,dilated,cv::Mat(1,41,CV_8U,cv::Scalar(1)));
+	morpho.setElementSize(cv::Size(41,1));
+	morpho.dilate(image,fastDilated);
+	std::cout << "41x1 dilate, different pixels= " << cv::countNonZero(dilated!=fastDilated) << std::endl;
+
+	// repeated iterations (as in segment.cpp)
+	// are done in a single pass with a larger rectangle
+	cv::erode(image,eroded,cv::Mat(),cv::Point(-1,-1),4);
+	morpho.setElementSize(cv::Size(3,3));
+	morpho.setIterations(4);
+	morpho.erode(image,fastEroded);
+	std::cout << "3x3 erode 4 times, different pixels= " << cv::countNonZero(eroded!=fastEroded) << std::endl;
+
+	// Display the eroded image
+	cv::namedWindow("Eroded Image (van Herk)");
+	cv::imshow("Eroded Image (van Herk)",fastEroded);
+
+	cv::waitKey();
+	return 0;
+}
@@ -0,0 +1,631 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 5 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#if !defined FMORPHO
+#define FMORPHO
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+
+// Minimum of two values (erosion)
+template <typename T>
+struct MinOp {
+
+	// value of the pixels outside the image
+	static T neutral() { return std::numeric_limits<T>::max(); }
+
+	T operator()(T a, T b) const { return std::min(a, b); }
+
+	// out[i]= min(a[i],b[i]) for n elements
+	static void rows(const T* a, const T* b, T* out, int n) {
+
+		for (int i= 0; i < n; i++)
+			out[i]= std::min(a[i], b[i]);
+	}
+};
+
+// Maximum of two values (dilation)
+template <typename T>
+struct MaxOp {
+
+	// value of the pixels outside the image
+	static T neutral() { return std::numeric_limits<T>::lowest(); }
+
+	T operator()(T a, T b) const { return std::max(a, b); }
+
+	// out[i]= max(a[i],b[i]) for n elements
+	static void rows(const T* a, const T* b, T* out, int n) {
+
+		for (int i= 0; i < n; i++)
+			out[i]= std::max(a[i], b[i]);
+	}
+};
+
+#if CV_SIMD128
+template <>
+inline void MinOp<uchar>::rows(const uchar* a, const uchar* b, uchar* out, int n) {
+
+	int i= 0;
+	for (; i <= n - 16; i+= 16)
+		cv::v_store(out + i, cv::v_min(cv::v_load(a + i), cv::v_load(b + i)));
+	for (; i < n; i++)
+		out[i]= std::min(a[i], b[i]);
+}
+
+template <>
+inline void MaxOp<uchar>::rows(const uchar* a, const uchar* b, uchar* out, int n) {
+
+	int i= 0;
+	for (; i <= n - 16; i+= 16)
+		cv::v_store(out + i, cv::v_max(cv::v_load(a + i), cv::v_load(b + i)));
+	for (; i < n; i++)
+		out[i]= std::max(a[i], b[i]);
+}
+#endif
+
+// Min or max over the horizontal windows of a row of nc pixels of cn channels
+// using the van Herk/Gil-Werman algorithm: the row is divided into blocks of the
+// window size in which cumulative values are computed forward (g) and backward (h);
+// any window covers the end of a block and the start of the next one,
+// such that its value is op(h[x],g[x+size-1]), whatever its size.
+// ext, g and h are work buffers.
+template <typename T, class Op>
+void vanHerkRow(const T* in, T* out, int nc, int cn, int size, int anchor,
+	            std::vector<T>& ext, std::vector<T>& g, std::vector<T>& h) {
+
+	Op op;
+	// number of pixels of the padded row, multiple of the window size
+	int length= (nc + size - 1 + size - 1)/size*size;
+	ext.resize(length*cn);
+	g.resize(length*cn);
+	h.resize(length*cn);
+
+	// the row padded with neutral values
+	std::fill(ext.begin(), ext.end(), Op::neutral());
+	std::copy(in, in + nc*cn, ext.begin() + anchor*cn);
+
+	// forward cumulative values in each block
+	for (int p= 0; p < length; p++) {
+
+		T* gp= &g[p*cn];
+		const T* e= &ext[p*cn];
+		if (p%size == 0)
+			for (int c= 0; c < cn; c++) gp[c]= e[c];
+		else
+			for (int c= 0; c < cn; c++) gp[c]= op(gp[c-cn], e[c]);
+	}
+
+	// backward cumulative values in each block
+	for (int p= length - 1; p >= 0; p--) {
+
+		T* hp= &h[p*cn];
+		const T* e= &ext[p*cn];
+		if (p%size == size - 1)
+			for (int c= 0; c < cn; c++) hp[c]= e[c];
+		else
+			for (int c= 0; c < cn; c++) hp[c]= op(hp[c+cn], e[c]);
+	}
+
+	// window [x-anchor, x-anchor+size[ of the row
+	// is [x, x+size[ in the padded row
+	Op::rows(&h[0], &g[(size - 1)*cn], out, nc*cn);
+}
+
+// Min or max over horizontal windows of a given size, in parallel bands of rows
+template <typename T, class Op>
+class VanHerkRows : public cv::ParallelLoopBody {
+
+	const cv::Mat& src;
+	cv::Mat& dst;
+	int size;    // window size
+	int anchor;  // position of the output pixel in the window
+
+  public:
+
+	VanHerkRows(const cv::Mat& src, cv::Mat& dst, int size, int anchor)
+		: src(src), dst(dst), size(size), anchor(anchor) {}
+
+	void operator()(const cv::Range& range) const {
+
+		std::vector<T> ext, g, h;
+		for (int j= range.start; j < range.end; j++)
+			vanHerkRow<T,Op>(src.ptr<T>(j), dst.ptr<T>(j), src.cols, src.channels(), size, anchor, ext, g, h);
+	}
+};
+
+// Min or max over vertical windows of a given size, in parallel stripes of columns,
+// using the van Herk/Gil-Werman algorithm.
+// Whole stripe rows are combined at once, which vectorizes.
+template <typename T, class Op>
+class VanHerkColumns : public cv::ParallelLoopBody {
+
+	const cv::Mat& src;
+	cv::Mat& dst;
+	int size;         // window size
+	int anchor;       // position of the output pixel in the window
+	int stripeWidth;  // number of elements in a stripe
+
+  public:
+
+	VanHerkColumns(const cv::Mat& src, cv::Mat& dst, int size, int anchor, int stripeWidth)
+		: src(src), dst(dst), size(size), anchor(anchor), stripeWidth(stripeWidth) {}
+
+	void operator()(const cv::Range& range) const {
+
+		int nl= src.rows;
+		int width= src.cols*src.channels();
+		// number of rows of the padded stripe, multiple of the window size
+		int length= (nl + size - 1 + size - 1)/size*size;
+		std::vector<T> g(length*stripeWidth), h(length*stripeWidth);
+		std::vector<T> neutral(stripeWidth, Op::neutral());
+
+		for (int s= range.start; s < range.end; s++) {
+
+			int x0= s*stripeWidth;
+			int n= std::min(stripeWidth, width - x0);
+
+			// row e of the padded stripe
+			auto row= [&](int e) -> const T* {
+				return e >= anchor && e - anchor < nl ? src.ptr<T>(e - anchor) + x0 : &neutral[0]; };
+
+			// forward cumulative values in each block
+			for (int e= 0; e < length; e++) {
+
+				T* ge= &g[e*stripeWidth];
+				if (e%size == 0)
+					std::copy(row(e), row(e) + n, ge);
+				else
+					Op::rows(ge - stripeWidth, row(e), ge, n);
+			}
+
+			// backward cumulative values in each block
+			for (int e= length - 1; e >= 0; e--) {
+
+				T* he= &h[e*stripeWidth];
+				if (e%size == size - 1)
+					std::copy(row(e), row(e) + n, he);
+				else
+					Op::rows(he + stripeWidth, row(e), he, n);
+			}
+
+			// window [y-anchor, y-anchor+size[ of the column
+			// is [y, y+size[ in the padded stripe
+			for (int y= 0; y < nl; y++)
+				Op::rows(&h[y*stripeWidth], &g[(y + size - 1)*stripeWidth], dst.ptr<T>(y) + x0, n);
+		}
+	}
+};
+
+// Morphological gradient, top-hat and black-hat with a rectangular element,
+// in parallel bands of rows.
+// Each band computes the erosions and dilations it needs in band buffers
+// and writes the difference directly, such that no intermediate image is stored.
+template <typename T>
+class MorphoBands : public cv::ParallelLoopBody {
+
+	// work buffers of a band
+	struct Buffers {
+
+		std::vector<T> ext, g, h;          // horizontal pass
+		std::vector<T> rows;               // result of the horizontal pass
+		std::vector<const T*> rowPtrs;
+		std::vector<T> vg, vh, neutral;    // vertical pass
+		std::vector<T> first, second;      // results of the two operators
+		std::vector<const T*> firstPtrs;
+		std::vector<T*> firstOut, secondOut;
+	};
+
+	const cv::Mat& src;
+	cv::Mat& dst;
+	int op;           // cv::MORPH_GRADIENT, cv::MORPH_TOPHAT or cv::MORPH_BLACKHAT
+	int w, h;         // element size
+	int ax, ay;       // element anchor
+	int bandHeight;
+
+	// applies Op with the rectangle to produce the rows [y0,y1[
+	// from the rows [first,first+n[ which are all the image rows
+	// inside the rectangles of the output rows
+	template <class Op>
+	void rectangle(const T* const* in, int first, int n, int y0, int y1, T* const* out, Buffers& b) const {
+
+		int cn= src.channels();
+		int width= src.cols*cn;
+		int m= y1 - y0;
+
+		// horizontal pass
+		const T* const* rows= in;
+		if (w > 1) {
+
+			b.rows.resize(n*width);
+			b.rowPtrs.resize(n);
+			for (int i= 0; i < n; i++) {
+
+				vanHerkRow<T,Op>(in[i], &b.rows[i*width], src.cols, cn, w, ax, b.ext, b.g, b.h);
+				b.rowPtrs[i]= &b.rows[i*width];
+			}
+			rows= &b.rowPtrs[0];
+		}
+
+		if (h == 1) {
+
+			for (int t= 0; t < m; t++)
+				std::copy(rows[y0 + t - first], rows[y0 + t - first] + width, out[t]);
+			return;
+		}
+
+		// vertical pass, the image row of the padded row e is y0-ay+e
+		int length= (m + h - 1 + h - 1)/h*h;
+		b.vg.resize(length*width);
+		b.vh.resize(length*width);
+		b.neutral.assign(width, Op::neutral());
+
+		auto row= [&](int e) -> const T* {
+			int i= y0 - ay + e - first;
+			return i >= 0 && i < n ? rows[i] : &b.neutral[0]; };
+
+		for (int e= 0; e < length; e++) {
+
+			T* ge= &b.vg[e*width];
+			if (e%h == 0)
+				std::copy(row(e), row(e) + width, ge);
+			else
+				Op::rows(ge - width, row(e), ge, width);
+		}
+
+		for (int e= length - 1; e >= 0; e--) {
+
+			T* he= &b.vh[e*width];
+			if (e%h == h - 1)
+				std::copy(row(e), row(e) + width, he);
+			else
+				Op::rows(he + width, row(e), he, width);
+		}
+
+		for (int t= 0; t < m; t++)
+			Op::rows(&b.vh[t*width], &b.vg[(t + h - 1)*width], out[t], width);
+	}
+
+	// image rows needed by the output rows [y0,y1[
+	void inputRows(int y0, int y1, int& first, int& last) const {
+
+		first= std::max(y0 - ay, 0);
+		last= std::min(y1 - ay + h - 1, src.rows);
+	}
+
+	// first operator then second operator
+	template <class Op1, class Op2>
+	void compose(int y0, int y1, Buffers& b) const {
+
+		int width= src.cols*src.channels();
+
+		// rows of the first result needed by the second operator
+		int a0, a1, i0, i1;
+		inputRows(y0, y1, a0, a1);
+		inputRows(a0, a1, i0, i1);
+
+		std::vector<const T*> in(i1 - i0);
+		for (int i= i0; i < i1; i++)
+			in[i - i0]= src.ptr<T>(i);
+
+		b.first.resize((a1 - a0)*width);
+		b.firstOut.resize(a1 - a0);
+		b.firstPtrs.resize(a1 - a0);
+		for (int i= 0; i < a1 - a0; i++)
+			b.firstPtrs[i]= b.firstOut[i]= &b.first[i*width];
+		rectangle<Op1>(&in[0], i0, i1 - i0, a0, a1, &b.firstOut[0], b);
+
+		// result in the second buffer
+		b.second.resize((y1 - y0)*width);
+		b.secondOut.resize(y1 - y0);
+		for (int i= 0; i < y1 - y0; i++)
+			b.secondOut[i]= &b.second[i*width];
+		rectangle<Op2>(&b.firstPtrs[0], a0, a1 - a0, y0, y1, &b.secondOut[0], b);
+	}
+
+  public:
+
+	MorphoBands(const cv::Mat& src, cv::Mat& dst, int op, int w, int h, int ax, int ay, int bandHeight)
+		: src(src), dst(dst), op(op), w(w), h(h), ax(ax), ay(ay), bandHeight(bandHeight) {}
+
+	// processes the bands in range
+	void operator()(const cv::Range& range) const {
+
+		Buffers b;
+		int width= src.cols*src.channels();
+
+		for (int band= range.start; band < range.end; band++) {
+
+			int y0= band*bandHeight;
+			int y1= std::min(y0 + bandHeight, src.rows);
+
+			if (op == cv::MORPH_GRADIENT) {
+
+				// erosion and dilation of the same rows
+				int i0, i1;
+				inputRows(y0, y1, i0, i1);
+				std::vector<const T*> in(i1 - i0);
+				for (int i= i0; i < i1; i++)
+					in[i - i0]= src.ptr<T>(i);
+
+				b.first.resize((y1 - y0)*width);
+				b.second.resize((y1 - y0)*width);
+				b.firstOut.resize(y1 - y0);
+				b.secondOut.resize(y1 - y0);
+				for (int i= 0; i < y1 - y0; i++) {
+					b.firstOut[i]= &b.first[i*width];
+					b.secondOut[i]= &b.second[i*width];
+				}
+				rectangle<MaxOp<T> >(&in[0], i0, i1 - i0, y0, y1, &b.firstOut[0], b);
+				rectangle<MinOp<T> >(&in[0], i0, i1 - i0, y0, y1, &b.secondOut[0], b);
+
+				// dilation - erosion
+				for (int j= y0; j < y1; j++) {
+
+					const T* dilated= b.firstOut[j - y0];
+					const T* eroded= b.secondOut[j - y0];
+					T* out= dst.ptr<T>(j);
+					for (int i= 0; i < width; i++)
+						out[i]= cv::saturate_cast<T>(dilated[i] - eroded[i]);
+				}
+
+			} else if (op == cv::MORPH_TOPHAT) {
+
+				// image - opening
+				compose<MinOp<T>,MaxOp<T> >(y0, y1, b);
+				for (int j= y0; j < y1; j++) {
+
+					const T* data= src.ptr<T>(j);
+					const T* opened= b.secondOut[j - y0];
+					T* out= dst.ptr<T>(j);
+					for (int i= 0; i < width; i++)
+						out[i]= cv::saturate_cast<T>(data[i] - opened[i]);
+				}
+
+			} else {
+
+				// closing - image
+				compose<MaxOp<T>,MinOp<T> >(y0, y1, b);
+				for (int j= y0; j < y1; j++) {
+
+					const T* data= src.ptr<T>(j);
+					const T* closed= b.secondOut[j - y0];
+					T* out= dst.ptr<T>(j);
+					for (int i= 0; i < width; i++)
+						out[i]= cv::saturate_cast<T>(closed[i] - data[i]);
+				}
+			}
+		}
+	}
+};
+
+// Erosion, dilation and their combinations with rectangular structuring elements
+// (including horizontal and vertical lines) in constant time per pixel
+// whatever the element size, using the van Herk/Gil-Werman algorithm.
+// The rectangle is decomposed into a horizontal and a vertical line,
+// each processed in parallel.
+// Same result as cv::erode, cv::dilate and cv::morphologyEx with a rectangular element
+// and the default border.
+class FastMorphology {
+
+  private:
+
+	cv::Size size;     // size of the structuring element
+	cv::Point anchor;  // its anchor, (-1,-1) for its center
+	int iterations;    // number of times the operator is applied
+	cv::Mat tmp;       // result of the horizontal pass
+
+	// applies op with a rectangle of size w x h, anchored at (ax,ay)
+	template <typename T, class Op>
+	void apply(const cv::Mat& image, cv::Mat& result, int w, int h, int ax, int ay) {
+
+		result.create(image.rows, image.cols, image.type());
+
+		const cv::Mat* src= &image;
+		if (w > 1) {
+
+			// horizontal line, directly in result if there is no vertical line
+			cv::Mat& out= h > 1 ? tmp : result;
+			out.create(image.rows, image.cols, image.type());
+			cv::parallel_for_(cv::Range(0, image.rows), VanHerkRows<T,Op>(*src, out, w, ax));
+			src= &out;
+		}
+
+		if (h > 1) {
+
+			// vertical line, by stripes of 256 elements
+			int width= image.cols*image.channels();
+			int stripeWidth= std::min(256, width);
+			cv::parallel_for_(cv::Range(0, (width + stripeWidth - 1)/stripeWidth),
+				VanHerkColumns<T,Op>(*src, result, h, ay, stripeWidth));
+		}
+
+		if (w <= 1 && h <= 1)
+			image.copyTo(result);
+	}
+
+	// size and anchor of the rectangle equivalent to the iterations
+	void equivalentElement(int& w, int& h, int& ax, int& ay) const {
+
+		// n iterations with a rectangle are equivalent to
+		// a single pass with a larger rectangle
+		int n= std::max(iterations, 1);
+		ax= n*(anchor.x < 0 ? size.width/2 : anchor.x);
+		ay= n*(anchor.y < 0 ? size.height/2 : anchor.y);
+		w= n*(size.width - 1) + 1;
+		h= n*(size.height - 1) + 1;
+	}
+
+	// gradient, top-hat or black-hat in a single pass
+	template <typename T>
+	void fused(const cv::Mat& image, cv::Mat& result, int op) {
+
+		int w, h, ax, ay;
+		equivalentElement(w, h, ax, ay);
+
+		// the bands read the neighbouring rows
+		cv::Mat input= image.data == result.data ? image.clone() : image;
+		result.create(image.rows, image.cols, image.type());
+
+		int bandHeight= std::max(32, h);
+		cv::parallel_for_(cv::Range(0, (image.rows + bandHeight - 1)/bandHeight),
+			MorphoBands<T>(input, result, op, w, h, ax, ay, bandHeight));
+	}
+
+	void fused(const cv::Mat& image, cv::Mat& result, int op) {
+
+		int depth= image.depth();
+		CV_Assert(depth == CV_8U || depth == CV_16U || depth == CV_16S || depth == CV_32F);
+
+		switch (depth) {
+
+		  case CV_8U:  fused<uchar>(image, result, op); break;
+		  case CV_16U: fused<ushort>(image, result, op); break;
+		  case CV_16S: fused<short>(image, result, op); break;
+		  case CV_32F: fused<float>(image, result, op); break;
+		}
+	}
+
+	template <template <typename> class Op>
+	void apply(const cv::Mat& image, cv::Mat& result) {
+
+		int w, h, ax, ay;
+		equivalentElement(w, h, ax, ay);
+
+		int depth= image.depth();
+		CV_Assert(depth == CV_8U || depth == CV_16U || depth == CV_16S || depth == CV_32F);
+
+		switch (depth) {
+
+		  case CV_8U:  apply<uchar,Op<uchar> >(image, result, w, h, ax, ay); break;
+		  case CV_16U: apply<ushort,Op<ushort> >(image, result, w, h, ax, ay); break;
+		  case CV_16S: apply<short,Op<short> >(image, result, w, h, ax, ay); break;
+		  case CV_32F: apply<float,Op<float> >(image, result, w, h, ax, ay); break;
+		}
+	}
+
+  public:
+
+	FastMorphology() : size(3,3), anchor(-1,-1), iterations(1) {}
+
+	// set the size of the rectangular structuring element
+	// use (n,1) or (1,n) for horizontal or vertical lines
+	void setElementSize(cv::Size s) {
+
+		size= s;
+	}
+
+	cv::Size getElementSize() {
+
+		return size;
+	}
+
+	// set the anchor of the structuring element
+	// (-1,-1) for its center
+	void setAnchor(cv::Point a) {
+
+		anchor= a;
+	}
+
+	// set the number of times the operators are applied
+	void setIterations(int n) {
+
+		iterations= n;
+	}
+
+	// erodes an image
+	void erode(const cv::Mat& image, cv::Mat& result) {
+
+		apply<MinOp>(image, result);
+	}
+
+	// dilates an image
+	void dilate(const cv::Mat& image, cv::Mat& result) {
+
+		apply<MaxOp>(image, result);
+	}
+
+	// opens an image (erosion then dilation)
+	void open(const cv::Mat& image, cv::Mat& result) {
+
+		erode(image, result);
+		dilate(result, result);
+	}
+
+	// closes an image (dilation then erosion)
+	void close(const cv::Mat& image, cv::Mat& result) {
+
+		dilate(image, result);
+		erode(result, result);
+	}
+
+	// morphological gradient (dilation - erosion)
+	void gradient(const cv::Mat& image, cv::Mat& result) {
+
+		fused(image, result, cv::MORPH_GRADIENT);
+	}
+
+	// top-hat transform (image - opening)
+	void topHat(const cv::Mat& image, cv::Mat& result) {
+
+		fused(image, result, cv::MORPH_TOPHAT);
+	}
+
+	// black top-hat transform (closing - image)
+	void blackHat(const cv::Mat& image, cv::Mat& result) {
+
+		fused(image, result, cv::MORPH_BLACKHAT);
+	}
+
+	// upper bound of the work buffers (in bytes) of one thread applying op
+	// to an image of the given size and type; the input, the result
+	// and the horizontal pass image are not included
+	size_t getBufferMemory(cv::Size s, int type, int op) const {
+
+		int w, h, ax, ay;
+		equivalentElement(w, h, ax, ay);
+
+		int width= s.width*CV_MAT_CN(type);
+		// padded row of the horizontal pass (ext, g and h)
+		size_t rowBuffers= w > 1 ? 3*static_cast<size_t>(s.width + 3*w)*CV_MAT_CN(type) : 0;
+		size_t elements;
+
+		if (op == cv::MORPH_GRADIENT || op == cv::MORPH_TOPHAT || op == cv::MORPH_BLACKHAT) {
+
+			// rows read by a band, through the two operators of the top-hats
+			size_t n= std::max(32, h) + 2*h;
+			elements= rowBuffers + width*((w > 1 ? n : 0) +            // horizontal pass
+			                              (h > 1 ? 2*(n + 2*h) + 1 : 0) + // vertical pass
+			                              2*n);                         // results of the operators
+
+		} else {
+
+			// padded stripe of the vertical pass (g, h and neutral)
+			size_t columnBuffers= h > 1 ? (2*static_cast<size_t>(s.height + 3*h) + 1)*std::min(256, width) : 0;
+			elements= std::max(rowBuffers, columnBuffers);
+		}
+
+		return elements*CV_ELEM_SIZE1(type);
+	}
+};
+
+#endif
@@ -19,6 +19,9 @@ Copyright (C) 2016 Robert Laganiere, www.laganiere.name
 #include <opencv2\core.hpp>
 #include <opencv2\imgproc.hpp>
 #include <opencv2\highgui.hpp>
+#include <iostream>
+
+#include "fastMorphology.h"
 
 int main()
 {
@@ -137,7 +140,20 @@ int main()
 	cv::imshow("Thresholded Edge Image", result);
 
 	// Get the gradient image using a 3x3 structuring element
+	int64 time= cv::getTickCount();
 	cv::morphologyEx(image, result, cv::MORPH_GRADIENT, cv::Mat());
+	time= cv::getTickCount() - time;
+	std::cout << "gradient (morphologyEx)= " << 1000.0*time/cv::getTickFrequency() << "ms" << std::endl;
+
+	// same gradient with min and max computed together
+	// without intermediate images
+	FastMorphology morpho;
+	cv::Mat fused;
+	time= cv::getTickCount();
+	morpho.gradient(image, fused);
+	time= cv::getTickCount() - time;
+	std::cout << "gradient (fused)= " << 1000.0*time/cv::getTickFrequency() << "ms, different pixels= "
+		      << cv::countNonZero(result != fused) << std::endl;
 
 	// Read input image (gray-level)
 	image = cv::imread("book.jpg", 0);
@@ -151,6 +167,11 @@ int main()
 	cv::Mat element7(7, 7, CV_8U, cv::Scalar(1));
 	cv::morphologyEx(image, result, cv::MORPH_BLACKHAT, element7);
 
+	// same black top-hat without intermediate images
+	morpho.setElementSize(cv::Size(7, 7));
+	morpho.blackHat(image, fused);
+	std::cout << "black top-hat (fused), different pixels= " << cv::countNonZero(result != fused) << std::endl;
+
 	// Display the top-hat image
 	cv::namedWindow("7x7 Black Top-hat Image");
 	cv::imshow("7x7 Black Top-hat Image", 255-result);
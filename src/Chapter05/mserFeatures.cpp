@@ -23,6 +23,8 @@ Copyright (C) 2016 Robert Laganiere, www.laganiere.name
 #include <opencv2/imgproc.hpp>
 #include <vector>
 
+#include "mserFeatures.h"
+
 int main()
 {
 	// Read input image
@@ -124,9 +126,13 @@ int main()
 	cv::namedWindow("MSER ellipses");
 	cv::imshow("MSER ellipses", image);
 
-	/*
 	// detection using mserFeatures class
 
+	// Reload the input image
+	image = cv::imread("building.jpg", 0);
+	if (!image.data)
+		return 0;
+
 	// create MSER feature detector instance
 	MSERFeatures mserF(200,  // min area 
 		               1500, // max area
@@ -134,14 +140,31 @@ int main()
 	                         // default delta is used
 
 	// the vector of bounding rotated rectangles
-	std::vector<cv::RotatedRect> rects;
+	std::vector<cv::RotatedRect> ellipses;
 
 	// detect and get the image
-	cv::Mat result= mserF.getImageOfEllipses(image,rects);
+	cv::Mat result= mserF.getImageOfEllipses(image,ellipses);
 
 	// display detected MSER
 	cv::namedWindow("MSER regions");
 	cv::imshow("MSER regions",result);
-	*/
+
+	// compare with the point sets of cv::MSER
+	int64 time= cv::getTickCount();
+	ptrMSER->detectRegions(image, points, rects);
+	time= cv::getTickCount()-time;
+	size_t nPoints= 0;
+	for (size_t i=0; i<points.size(); i++)
+		nPoints+= points[i].size();
+	std::cout << "cv::MSER: " << points.size() << " regions in " << 1000.0*time/cv::getTickFrequency()
+		      << "ms, " << nPoints*sizeof(cv::Point) << " bytes of points" << std::endl;
+
+	std::vector<MSERRegion> regions;
+	time= cv::getTickCount();
+	mserF.detect(image, regions);
+	time= cv::getTickCount()-time;
+	std::cout << "MSERFeatures: " << regions.size() << " regions in " << 1000.0*time/cv::getTickFrequency()
+		      << "ms, " << regions.size()*sizeof(MSERRegion) << " bytes of regions" << std::endl;
+
 	cv::waitKey();
 }
@@ -0,0 +1,390 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 5 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#if !defined MSERF
+#define MSERF
+
+#include <cmath>
+#include <climits>
+#include <cfloat>
+#include <vector>
+#include <algorithm>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+// A maximally stable region described by its moments
+struct MSERRegion {
+
+	int level;            // gray level of the region
+	int area;             // number of pixels
+	double variation;     // area variation over delta levels (stability)
+	cv::Point2d centroid;
+	double cxx, cxy, cyy; // covariance of the pixel coordinates
+	cv::Rect box;         // bounding box
+	bool bright;          // true for a bright region on a darker background
+
+	// ellipse having the same second order moments as the region
+	cv::RotatedRect ellipse() const {
+
+		// eigenvalues and main direction of the covariance matrix
+		double t= (cxx + cyy)/2.0;
+		double d= std::sqrt((cxx - cyy)*(cxx - cyy)/4.0 + cxy*cxy);
+		double l1= t + d, l2= std::max(t - d, 0.0);
+		double angle= 0.5*std::atan2(2.0*cxy, cxx - cyy)*180.0/CV_PI;
+
+		// a uniform ellipse of semi-axis a has a variance of a^2/4
+		return cv::RotatedRect(cv::Point2f(static_cast<float>(centroid.x), static_cast<float>(centroid.y)),
+			                   cv::Size2f(static_cast<float>(4.0*std::sqrt(l1)), static_cast<float>(4.0*std::sqrt(l2))),
+							   static_cast<float>(angle));
+	}
+};
+
+// Extracts the MSERs of one 8-bit image.
+// The component tree of the lower level sets is built by union-find
+// over the pixels sorted by gray level; the area, moments and bounding box
+// of each component are accumulated while the tree is built, such that
+// no point list is ever stored. Per pixel, only three integers are used.
+class MSERTree {
+
+	// a component of the tree (canonical pixel of a level component)
+	struct Node {
+
+		int level;
+		int parent;          // parent node, -1 for the root
+		int area;
+		long long sx, sy, sxx, sxy, syy;
+		int minx, miny, maxx, maxy;
+		float variation;
+		float minChildVariation;
+	};
+
+	int delta;
+	int minArea, maxArea;
+	float maxVariation;
+
+	// adds a new empty node for a canonical pixel at a given level
+	static int addNode(std::vector<Node>& nodes, int level) {
+
+		Node node;
+		node.level= level;
+		node.parent= -1;
+		node.area= 0;
+		node.sx= node.sy= node.sxx= node.sxy= node.syy= 0;
+		node.minx= node.miny= INT_MAX;
+		node.maxx= node.maxy= -1;
+		node.variation= 0.0f;
+		node.minChildVariation= FLT_MAX;
+		nodes.push_back(node);
+
+		return static_cast<int>(nodes.size()) - 1;
+	}
+
+	static int find(std::vector<int>& zpar, int p) {
+
+		int r= p;
+		while (zpar[r] != r)
+			r= zpar[r];
+
+		// path compression
+		while (zpar[p] != r) {
+			int next= zpar[p];
+			zpar[p]= r;
+			p= next;
+		}
+
+		return r;
+	}
+
+  public:
+
+	MSERTree(int delta, int minArea, int maxArea, float maxVariation)
+		: delta(delta), minArea(minArea), maxArea(maxArea), maxVariation(maxVariation) {}
+
+	// detects the dark regions of image (invert the image for the bright ones)
+	void detect(const cv::Mat& image, std::vector<MSERRegion>& regions, bool bright) const {
+
+		CV_Assert(image.type() == CV_8U);
+
+		int nl= image.rows;
+		int nc= image.cols;
+		int n= nl*nc;
+		if (n == 0)
+			return;
+
+		// pixels sorted by increasing gray level (counting sort)
+		std::vector<int> start(257, 0);
+		for (int j= 0; j < nl; j++) {
+			const uchar* data= image.ptr<uchar>(j);
+			for (int i= 0; i < nc; i++)
+				start[data[i] + 1]++;
+		}
+		for (int v= 1; v <= 256; v++)
+			start[v]+= start[v-1];
+
+		std::vector<int> order(n);
+		{
+			std::vector<int> pos(start.begin(), start.end() - 1);
+			for (int j= 0; j < nl; j++) {
+				const uchar* data= image.ptr<uchar>(j);
+				for (int i= 0; i < nc; i++)
+					order[pos[data[i]]++]= j*nc + i;
+			}
+		}
+
+		// union-find: the parent of a component is processed after it
+		std::vector<int> parent(n, -1);
+		std::vector<int> zpar(n, -1);
+		for (int k= 0; k < n; k++) {
+
+			int p= order[k];
+			parent[p]= p;
+			zpar[p]= p;
+			int x= p%nc, y= p/nc;
+
+			int neighbours[4]= { y > 0 ? p - nc : -1, x > 0 ? p - 1 : -1,
+				                 x < nc - 1 ? p + 1 : -1, y < nl - 1 ? p + nc : -1 };
+			for (int q= 0; q < 4; q++) {
+
+				int nb= neighbours[q];
+				if (nb < 0 || zpar[nb] < 0) // not processed yet
+					continue;
+
+				int r= find(zpar, nb);
+				if (r != p) {
+					parent[r]= p;
+					zpar[r]= p;
+				}
+			}
+		}
+
+		// level of a pixel
+		auto level= [&](int p) -> int { return image.ptr<uchar>(p/nc)[p%nc]; };
+
+		// canonicalization: the parent of a pixel becomes the canonical pixel
+		// of its level component (processed from the root down)
+		for (int k= n - 1; k >= 0; k--) {
+
+			int p= order[k];
+			int q= parent[p];
+			if (level(parent[q]) == level(q))
+				parent[p]= parent[q];
+		}
+
+		// the attributes are accumulated from the leaves to the root;
+		// zpar now holds the node of each canonical pixel
+		std::vector<Node> nodes;
+		std::fill(zpar.begin(), zpar.end(), -1);
+
+		for (int k= 0; k < n; k++) {
+
+			int p= order[k];
+			bool canonical= parent[p] == p || level(parent[p]) != level(p);
+			int c= canonical ? p : parent[p];
+
+			if (zpar[c] < 0)
+				zpar[c]= addNode(nodes, level(c));
+
+			// adds the pixel to its node
+			Node& node= nodes[zpar[c]];
+			long long x= p%nc, y= p/nc;
+			node.area++;
+			node.sx+= x; node.sy+= y;
+			node.sxx+= x*x; node.sxy+= x*y; node.syy+= y*y;
+			node.minx= std::min(node.minx, static_cast<int>(x));
+			node.maxx= std::max(node.maxx, static_cast<int>(x));
+			node.miny= std::min(node.miny, static_cast<int>(y));
+			node.maxy= std::max(node.maxy, static_cast<int>(y));
+
+			// the node is complete when its canonical pixel is reached:
+			// it is added to its parent
+			if (p == c && parent[p] != p) {
+
+				// canonical pixel of the parent component
+				int pc= parent[p];
+				if (zpar[pc] < 0)
+					zpar[pc]= addNode(nodes, level(pc));
+
+				Node& child= nodes[zpar[c]];
+				Node& father= nodes[zpar[pc]];
+				child.parent= zpar[pc];
+				father.area+= child.area;
+				father.sx+= child.sx; father.sy+= child.sy;
+				father.sxx+= child.sxx; father.sxy+= child.sxy; father.syy+= child.syy;
+				father.minx= std::min(father.minx, child.minx);
+				father.maxx= std::max(father.maxx, child.maxx);
+				father.miny= std::min(father.miny, child.miny);
+				father.maxy= std::max(father.maxy, child.maxy);
+			}
+		}
+
+		// area variation: relative area increase over delta levels
+		for (size_t i= 0; i < nodes.size(); i++) {
+
+			int a= static_cast<int>(i);
+			while (nodes[a].parent >= 0 && nodes[nodes[a].parent].level <= nodes[i].level + delta)
+				a= nodes[a].parent;
+
+			nodes[i].variation= static_cast<float>(nodes[a].area - nodes[i].area)/nodes[i].area;
+		}
+
+		for (size_t i= 0; i < nodes.size(); i++)
+			if (nodes[i].parent >= 0) {
+				Node& father= nodes[nodes[i].parent];
+				father.minChildVariation= std::min(father.minChildVariation, nodes[i].variation);
+			}
+
+		// the MSERs are the local minima of the variation
+		for (size_t i= 0; i < nodes.size(); i++) {
+
+			const Node& node= nodes[i];
+			if (node.area < minArea || node.area > maxArea || node.variation > maxVariation)
+				continue;
+			if (node.parent >= 0 && node.variation >= nodes[node.parent].variation)
+				continue;
+			if (node.variation > node.minChildVariation)
+				continue;
+
+			MSERRegion r;
+			r.level= bright ? 255 - node.level : node.level;
+			r.area= node.area;
+			r.variation= node.variation;
+			double a= node.area;
+			r.centroid= cv::Point2d(node.sx/a, node.sy/a);
+			r.cxx= node.sxx/a - r.centroid.x*r.centroid.x;
+			r.cxy= node.sxy/a - r.centroid.x*r.centroid.y;
+			r.cyy= node.syy/a - r.centroid.y*r.centroid.y;
+			r.box= cv::Rect(node.minx, node.miny, node.maxx - node.minx + 1, node.maxy - node.miny + 1);
+			r.bright= bright;
+			regions.push_back(r);
+		}
+	}
+};
+
+// Detects the MSERs of the channels and polarities of an image in parallel
+class MSERJobs : public cv::ParallelLoopBody {
+
+	const std::vector<cv::Mat>& images;   // one image per job
+	const std::vector<bool>& bright;      // polarity of each job
+	const MSERTree& tree;
+	std::vector<std::vector<MSERRegion> >& results;
+
+  public:
+
+	MSERJobs(const std::vector<cv::Mat>& images, const std::vector<bool>& bright,
+		     const MSERTree& tree, std::vector<std::vector<MSERRegion> >& results)
+		: images(images), bright(bright), tree(tree), results(results) {}
+
+	void operator()(const cv::Range& range) const {
+
+		for (int i= range.start; i < range.end; i++)
+			tree.detect(images[i], results[i], bright[i]);
+	}
+};
+
+// MSER feature detector returning the moments of the regions
+// instead of their point sets.
+class MSERFeatures {
+
+  private:
+
+	MSERTree tree;
+	double minAreaRatio;   // extra rejection parameter
+	bool detectDark;       // dark regions on a brighter background
+	bool detectBright;     // bright regions on a darker background
+
+  public:
+
+	MSERFeatures(int minArea=60, int maxArea=14400, // acceptable size range
+		         double minAreaRatio=0.5,  // min value for MSER area/ellipse area
+				 int delta=5,              // delta value used for stability measure
+				 double maxVariation=0.25) // max allowed area variation
+		: tree(delta, minArea, maxArea, static_cast<float>(maxVariation)),
+		  minAreaRatio(minAreaRatio), detectDark(true), detectBright(true) {}
+
+	// select the polarities of the regions to be detected
+	void setPolarities(bool dark, bool bright) {
+
+		detectDark= dark;
+		detectBright= bright;
+	}
+
+	// detects the MSERs of each channel of an image
+	// the channels and polarities are processed in parallel
+	void detect(const cv::Mat& image, std::vector<MSERRegion>& regions) {
+
+		std::vector<cv::Mat> channels;
+		cv::split(image, channels);
+
+		std::vector<cv::Mat> images;
+		std::vector<bool> bright;
+		for (size_t c= 0; c < channels.size(); c++) {
+
+			if (detectDark) {
+				images.push_back(channels[c]);
+				bright.push_back(false);
+			}
+			if (detectBright) {
+				images.push_back(255 - channels[c]);
+				bright.push_back(true);
+			}
+		}
+
+		std::vector<std::vector<MSERRegion> > results(images.size());
+		cv::parallel_for_(cv::Range(0, static_cast<int>(images.size())),
+			MSERJobs(images, bright, tree, results));
+
+		regions.clear();
+		for (size_t i= 0; i < results.size(); i++)
+			regions.insert(regions.end(), results[i].begin(), results[i].end());
+	}
+
+	// get the ellipses of the MSERs
+	// whose area is close enough to the ellipse area
+	void getBoundingRects(const cv::Mat &image, std::vector<cv::RotatedRect> &rects) {
+
+		std::vector<MSERRegion> regions;
+		detect(image, regions);
+
+		rects.clear();
+		for (size_t i= 0; i < regions.size(); i++) {
+
+			cv::RotatedRect rr= regions[i].ellipse();
+			double ellipseArea= CV_PI*rr.size.width*rr.size.height/4.0;
+
+			// ratio test
+			if (ellipseArea > 0.0 && regions[i].area/ellipseArea > minAreaRatio)
+				rects.push_back(rr);
+		}
+	}
+
+	// draw the ellipses of the MSERs on a copy of the image
+	cv::Mat getImageOfEllipses(const cv::Mat &image, std::vector<cv::RotatedRect> &rects,
+		                       cv::Scalar color=255) {
+
+		getBoundingRects(image, rects);
+
+		cv::Mat output= image.clone();
+		for (size_t i= 0; i < rects.size(); i++)
+			cv::ellipse(output, rects[i], color);
+
+		return output;
+	}
+};
+
+#endif
@@ -0,0 +1,112 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 5 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#if !defined TILEGRID
+#define TILEGRID
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+// Division of an image into a grid of tiles, numbered row by row.
+// Each tile is processed inside an extended rectangle: the tile plus a halo
+// of neighbouring pixels, cut at the image limits. A chain of neighbourhood
+// filters whose reach does not exceed the halo then gives the same values
+// inside the tile as on the whole image, and where the extended rectangle
+// touches the image limits the border extrapolation is the one of the whole image.
+class TileGrid {
+
+	cv::Size imageSize;
+	cv::Size tileSize;
+	cv::Size halo;     // margin added on each side of a tile
+	int nTilesX;       // number of tiles per row of tiles
+
+  public:
+
+	TileGrid(cv::Size imageSize, cv::Size tileSize, cv::Size halo)
+		: imageSize(imageSize), tileSize(tileSize), halo(halo),
+		  nTilesX((imageSize.width + tileSize.width - 1)/tileSize.width) {
+
+		CV_Assert(tileSize.width > 0 && tileSize.height > 0);
+	}
+
+	// number of tiles
+	int size() const {
+
+		return nTilesX*((imageSize.height + tileSize.height - 1)/tileSize.height);
+	}
+
+	// tile t in image coordinates
+	cv::Rect tile(int t) const {
+
+		cv::Rect r(cv::Point((t%nTilesX)*tileSize.width, (t/nTilesX)*tileSize.height), tileSize);
+		return r & cv::Rect(cv::Point(0, 0), imageSize);
+	}
+
+	// tile t and its halo in image coordinates
+	cv::Rect extended(int t) const {
+
+		cv::Rect r= tile(t);
+		cv::Rect e(r.x - halo.width, r.y - halo.height, r.width + 2*halo.width, r.height + 2*halo.height);
+		return e & cv::Rect(cv::Point(0, 0), imageSize);
+	}
+};
+
+// Parallel loop over the tiles of a grid.
+// Worker is a copyable class called as worker(t, tile, extended) for each tile;
+// each call processes a stripe of consecutive tiles with its own copy of the
+// prototype, so that the buffers kept by a worker are reused from tile to tile
+// of the stripe without being shared.
+template <class Worker>
+class TileLoop : public cv::ParallelLoopBody {
+
+	const TileGrid& grid;
+	const Worker& prototype;
+
+  public:
+
+	TileLoop(const TileGrid& grid, const Worker& prototype)
+		: grid(grid), prototype(prototype) {}
+
+	void operator()(const cv::Range& range) const {
+
+		Worker worker(prototype);
+		for (int t= range.start; t < range.end; t++)
+			worker(t, grid.tile(t), grid.extended(t));
+	}
+};
+
+// processes the tiles from first to the last one in parallel;
+// the tiles are split into one stripe per thread, so that
+// the worker is copied once per thread and not once per tile
+template <class Worker>
+void forEachTile(const TileGrid& grid, const Worker& worker, int first= 0) {
+
+	cv::parallel_for_(cv::Range(first, grid.size()), TileLoop<Worker>(grid, worker),
+		              static_cast<double>(cv::getNumThreads()));
+}
+
+// halo of a morphological operation (cv::MORPH_*) with a rectangular element;
+// opening, closing and the top-hats apply the element twice in sequence,
+// the gradient applies it twice side by side
+inline cv::Size morphologyHalo(int op, cv::Size element, int iterations= 1) {
+
+	int n= (op == cv::MORPH_ERODE || op == cv::MORPH_DILATE || op == cv::MORPH_GRADIENT) ? 1 : 2;
+	return cv::Size(n*iterations*(element.width/2), n*iterations*(element.height/2));
+}
+
+#endif
@@ -0,0 +1,75 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 5 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#include <iostream>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/highgui.hpp>
+
+#include "tiledMorphology.h"
+
+int main()
+{
+	// Read input image (gray-level)
+	cv::Mat image= cv::imread("boldt.jpg",0);
+	if (!image.data)
+		return 0; 
+
+	// the image is written to a raw file from which tiles are read;
+	// a gigapixel image would be written there directly by its producer
+	RawImageFile input, output;
+	if (!input.save("boldt.raw",image) || 
+		!output.create("boldt-filtered.raw",image.rows,image.cols,image.type()))
+		return 0;
+
+	// a chain of morphological filters
+	TiledMorphology tiled;
+	tiled.setTileSize(cv::Size(64,64));
+	tiled.addOperation(cv::MORPH_OPEN,cv::Size(5,5));
+	tiled.addOperation(cv::MORPH_CLOSE,cv::Size(7,7));
+	tiled.addOperation(cv::MORPH_GRADIENT,cv::Size(3,3));
+
+	cv::Size halo= tiled.getHalo();
+	std::cout << "halo= " << halo.width << "x" << halo.height 
+		      << ", memory per tile worker= " << tiled.getTileMemory(image.type()) << " bytes" << std::endl;
+
+	int64 time= cv::getTickCount();
+	if (!tiled.process(input,output)) {
+		std::cout << "Error processing the tiles" << std::endl;
+		return 0;
+	}
+	time= cv::getTickCount()-time;
+	std::cout << "tiled processing= " << 1000.0*time/cv::getTickFrequency() << "ms" << std::endl;
+
+	// the same chain applied on the whole image
+	cv::Mat result;
+	cv::morphologyEx(image,result,cv::MORPH_OPEN,cv::Mat(5,5,CV_8U,cv::Scalar(1)));
+	cv::morphologyEx(result,result,cv::MORPH_CLOSE,cv::Mat(7,7,CV_8U,cv::Scalar(1)));
+	cv::morphologyEx(result,result,cv::MORPH_GRADIENT,cv::Mat(3,3,CV_8U,cv::Scalar(1)));
+
+	// both results should be identical
+	cv::Mat tiledResult= output.load();
+	std::cout << "different pixels= " << cv::countNonZero(result!=tiledResult) << std::endl;
+
+	// Display the result
+	cv::namedWindow("Tiled Morphology");
+	cv::imshow("Tiled Morphology",tiledResult);
+
+	cv::waitKey();
+	return 0;
+}
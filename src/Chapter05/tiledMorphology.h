@@ -0,0 +1,282 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 5 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#if !defined TMORPHO
+#define TMORPHO
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "fastMorphology.h"
+#include "tileGrid.h"
+
+// An image stored in a raw binary file, read and written by rectangular tiles
+// such that images larger than the memory can be processed.
+// File format: "RIMG", rows, cols, type (32-bit integers), then the pixels row by row.
+class RawImageFile {
+
+	std::string filename;
+	int rows, cols, type;
+
+	std::streamoff offset(int x, int y) const {
+
+		return 16 + (static_cast<std::streamoff>(y)*cols + x)*static_cast<std::streamoff>(CV_ELEM_SIZE(type));
+	}
+
+  public:
+
+	RawImageFile() : rows(0), cols(0), type(0) {}
+
+	// creates a file for an image of the given size and type
+	bool create(const std::string& name, int r, int c, int t) {
+
+		std::ofstream file(name.c_str(), std::ios::binary | std::ios::trunc);
+		if (!file)
+			return false;
+
+		int header[4]= { 0, r, c, t };
+		std::memcpy(header, "RIMG", 4);
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+		// sets the file size
+		filename= name;
+		rows= r;
+		cols= c;
+		type= t;
+		if (r > 0 && c > 0) {
+			file.seekp(offset(c - 1, r - 1) + CV_ELEM_SIZE(t) - 1);
+			file.put(0);
+		}
+
+		return static_cast<bool>(file);
+	}
+
+	// opens an existing file
+	bool open(const std::string& name) {
+
+		std::ifstream file(name.c_str(), std::ios::binary);
+		int header[4];
+		if (!file.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+			std::memcmp(header, "RIMG", 4) != 0)
+			return false;
+
+		filename= name;
+		rows= header[1];
+		cols= header[2];
+		type= header[3];
+
+		return true;
+	}
+
+	int getRows() const { return rows; }
+	int getCols() const { return cols; }
+	int getType() const { return type; }
+
+	// reads a tile
+	// each call opens its own stream such that tiles can be read in parallel
+	bool read(const cv::Rect& r, cv::Mat& tile) const {
+
+		std::ifstream file(filename.c_str(), std::ios::binary);
+		tile.create(r.height, r.width, type);
+		size_t length= r.width*tile.elemSize();
+
+		for (int j= 0; j < r.height && file; j++) {
+
+			file.seekg(offset(r.x, r.y + j));
+			file.read(reinterpret_cast<char*>(tile.ptr(j)), length);
+		}
+
+		return static_cast<bool>(file);
+	}
+
+	// writes a tile
+	// tiles that do not overlap can be written in parallel
+	bool write(const cv::Rect& r, const cv::Mat& tile) const {
+
+		CV_Assert(tile.type() == type && tile.rows == r.height && tile.cols == r.width);
+
+		std::fstream file(filename.c_str(), std::ios::binary | std::ios::in | std::ios::out);
+		size_t length= r.width*tile.elemSize();
+
+		for (int j= 0; j < r.height && file; j++) {
+
+			file.seekp(offset(r.x, r.y + j));
+			file.write(reinterpret_cast<const char*>(tile.ptr(j)), length);
+		}
+
+		return static_cast<bool>(file);
+	}
+
+	// writes a whole image to a file
+	bool save(const std::string& name, const cv::Mat& image) {
+
+		return create(name, image.rows, image.cols, image.type()) &&
+			   write(cv::Rect(0, 0, image.cols, image.rows), image);
+	}
+
+	// reads the whole image
+	cv::Mat load() const {
+
+		cv::Mat image;
+		read(cv::Rect(0, 0, cols, rows), image);
+
+		return image;
+	}
+};
+
+// One operation of a morphological chain
+struct MorphoOperation {
+
+	int op;            // cv::MORPH_* operator
+	cv::Size element;  // rectangular structuring element
+};
+
+// Tile worker applying a chain of morphological operations:
+// a tile is read with its halo, filtered, and its exact part written back.
+template <class Reader, class Writer>
+class TileWorker {
+
+	const Reader& input;
+	const Writer& output;
+	const std::vector<MorphoOperation>& chain;
+	std::vector<uchar>& status;  // 1 if the tile was processed
+	FastMorphology morpho;
+	cv::Mat buffer, result;
+
+  public:
+
+	TileWorker(const Reader& input, const Writer& output, const std::vector<MorphoOperation>& chain,
+		       std::vector<uchar>& status)
+		: input(input), output(output), chain(chain), status(status) {}
+
+	void operator()(int t, const cv::Rect& tile, const cv::Rect& extended) {
+
+		if (!input.read(extended, buffer)) {
+			status[t]= 0;
+			return;
+		}
+
+		for (size_t i= 0; i < chain.size(); i++) {
+
+			morpho.setElementSize(chain[i].element);
+			switch (chain[i].op) {
+
+			  case cv::MORPH_ERODE:    morpho.erode(buffer, result); break;
+			  case cv::MORPH_DILATE:   morpho.dilate(buffer, result); break;
+			  case cv::MORPH_OPEN:     morpho.open(buffer, result); break;
+			  case cv::MORPH_CLOSE:    morpho.close(buffer, result); break;
+			  case cv::MORPH_GRADIENT: morpho.gradient(buffer, result); break;
+			  case cv::MORPH_TOPHAT:   morpho.topHat(buffer, result); break;
+			  case cv::MORPH_BLACKHAT: morpho.blackHat(buffer, result); break;
+			}
+			std::swap(buffer, result);
+		}
+
+		status[t]= output.write(tile, buffer(tile - extended.tl()));
+	}
+};
+
+// Morphology of images that do not fit in memory.
+// The image is processed by tiles read from and written to RawImageFile objects
+// by parallel workers; only a few tiles (with their halo) are in memory at once.
+class TiledMorphology {
+
+	std::vector<MorphoOperation> chain;
+	cv::Size tileSize;
+
+  public:
+
+	TiledMorphology() : tileSize(1024, 1024) {}
+
+	// set the size of the tiles
+	void setTileSize(cv::Size s) {
+
+		tileSize= s;
+	}
+
+	// add an operation at the end of the chain
+	// (cv::MORPH_ERODE, DILATE, OPEN, CLOSE, GRADIENT, TOPHAT or BLACKHAT)
+	void addOperation(int op, cv::Size element) {
+
+		MorphoOperation m= { op, element };
+		chain.push_back(m);
+	}
+
+	void clear() {
+
+		chain.clear();
+	}
+
+	// margin needed around a tile for the chain result to be exact
+	cv::Size getHalo() const {
+
+		cv::Size halo(0, 0);
+		for (size_t i= 0; i < chain.size(); i++) {
+
+			cv::Size h= morphologyHalo(chain[i].op, chain[i].element);
+			halo.width+= h.width;
+			halo.height+= h.height;
+		}
+
+		return halo;
+	}
+
+	// upper bound of the memory used by one tile worker (bytes)
+	// for images of the given type
+	size_t getTileMemory(int type) const {
+
+		cv::Size halo= getHalo();
+		cv::Size extended(tileSize.width + 2*halo.width, tileSize.height + 2*halo.height);
+
+		// largest work buffers of the operations of the chain
+		FastMorphology morpho;
+		size_t buffers= 0;
+		for (size_t i= 0; i < chain.size(); i++) {
+
+			morpho.setElementSize(chain[i].element);
+			buffers= std::max(buffers, morpho.getBufferMemory(extended, type, chain[i].op));
+		}
+
+		// tile buffer, result and horizontal pass of FastMorphology
+		return 3*static_cast<size_t>(extended.width)*extended.height*CV_ELEM_SIZE(type) + buffers;
+	}
+
+	// processes an image file into another one of same size and type
+	// (e.g. created with RawImageFile::create)
+	// returns false if a tile could not be read or written
+	bool process(const RawImageFile& input, const RawImageFile& output) {
+
+		CV_Assert(input.getRows() == output.getRows() && input.getCols() == output.getCols() &&
+			      input.getType() == output.getType());
+
+		TileGrid grid(cv::Size(input.getCols(), input.getRows()), tileSize, getHalo());
+		std::vector<uchar> status(grid.size(), 0);
+
+		forEachTile(grid, TileWorker<RawImageFile,RawImageFile>(input, output, chain, status));
+
+		return std::find(status.begin(), status.end(), 0) == status.end();
+	}
+};
+
+#endif
@@ -0,0 +1,76 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 5 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#include <iostream>
+#include <opencv2/core.hpp>
+#include <opencv2/highgui.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+#include "watershedSegmentation.h"
+
+int main()
+{
+	// Open the video file
+	cv::VideoCapture capture("bike.avi");
+	if (!capture.isOpened())
+		return 0;
+
+	cv::Mat frame;
+	if (!capture.read(frame))
+		return 0;
+
+	// Identify background pixels (along the frame border)
+	cv::Mat markers(frame.size(),CV_8U,cv::Scalar(0));
+	cv::rectangle(markers,cv::Point(5,5),cv::Point(frame.cols-5,frame.rows-5),cv::Scalar(255),3);
+	// Identify foreground pixels (in the middle of the frame)
+	cv::rectangle(markers,cv::Point(frame.cols/2-10,frame.rows/2-10),
+						  cv::Point(frame.cols/2+10,frame.rows/2+10),cv::Scalar(1),10);
+
+	// Create watershed segmentation object
+	WatershedSegmenter segmenter;
+	segmenter.setMarkers(markers);
+	segmenter.setLevels(2);             // coarse segmentation at 1/4 resolution
+	segmenter.setChangeThreshold(20.0); // gradient change that triggers a new flooding
+
+	cv::namedWindow("Watersheds");
+	double totalTime= 0.0;
+	int nFrames= 0;
+
+	do {
+
+		int64 time= cv::getTickCount();
+		segmenter.processFrame(frame);
+		time= cv::getTickCount()-time;
+		totalTime+= 1000.0*time/cv::getTickFrequency();
+		nFrames++;
+
+		std::cout << "frame " << nFrames << ": " << segmenter.getChangedPixels() 
+			      << " pixels segmented in " << 1000.0*time/cv::getTickFrequency() << "ms" << std::endl;
+
+		// Display watersheds
+		cv::imshow("Watersheds",segmenter.getWatersheds());
+		if (cv::waitKey(10) >= 0)
+			break;
+
+	} while (capture.read(frame));
+
+	std::cout << "average time= " << totalTime/nFrames << "ms per frame" << std::endl;
+
+	cv::waitKey();
+	return 0;
+}
@@ -19,6 +19,9 @@ Copyright (C) 2016 Robert Laganiere, www.laganiere.name
 #if !defined WATERSHS
 #define WATERSHS
 
+#include <vector>
+#include <algorithm>
+
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 
@@ -28,12 +31,166 @@ class WatershedSegmenter {
 
 	  cv::Mat markers;
 
+	  // video mode
+	  cv::Mat seeds;            // markers given by the user
+	  cv::Mat gradient;         // reduced gradient of the previous frame
+	  bool restart;             // true if the next frame must be fully segmented
+	  int levels;               // number of pyramid levels of the coarse segmentation
+	  double changeThreshold;   // gradient change of the regions to be re-flooded
+	  int changedPixels;        // number of pixels re-flooded in the last frame
+
+	  // gradient of the frame reduced by the number of levels
+	  void reducedGradient(const cv::Mat& frame, cv::Mat& result) {
+
+		cv::Mat reduced;
+		if (frame.channels() == 3)
+			cv::cvtColor(frame,reduced,cv::COLOR_BGR2GRAY);
+		else
+			reduced= frame;
+
+		for (int i=0; i<levels; i++)
+			cv::pyrDown(reduced,reduced);
+
+		cv::morphologyEx(reduced,result,cv::MORPH_GRADIENT,cv::Mat());
+	  }
+
+	  // hierarchical segmentation:
+	  // watershed on the reduced frame, then refinement of the region
+	  // boundaries only on the full size frame
+	  void segment(const cv::Mat& frame) {
+
+		markers= seeds.clone();
+		if (levels > 0) {
+
+			cv::Mat reduced= frame;
+			for (int i=0; i<levels; i++)
+				cv::pyrDown(reduced,reduced);
+
+			// the markers are grown before subsampling such that thin strokes
+			// are not skipped (in float since cv::dilate does not support CV_32S;
+			// where two markers meet, the larger label wins)
+			cv::Mat coarse;
+			seeds.convertTo(coarse,CV_32F);
+			cv::dilate(coarse,coarse,cv::Mat(),cv::Point(-1,-1),1<<levels);
+			cv::resize(coarse,coarse,reduced.size(),0,0,cv::INTER_NEAREST);
+			coarse.convertTo(coarse,CV_32S);
+			cv::watershed(reduced,coarse);
+			cv::resize(coarse,markers,frame.size(),0,0,cv::INTER_NEAREST);
+
+			// the pixels near the coarse boundaries are flooded again
+			cv::Mat uncertain= markers==-1;
+			cv::dilate(uncertain,uncertain,cv::Mat(),cv::Point(-1,-1),1<<levels);
+			markers.setTo(cv::Scalar(0),uncertain);
+			// user markers take precedence
+			seeds.copyTo(markers,seeds!=0);
+		}
+
+		cv::watershed(frame,markers);
+		changedPixels= frame.rows*frame.cols;
+	  }
+
+	  // re-floods the regions whose gradient changed since the previous frame
+	  // starting from the labels of the previous frame
+	  void update(const cv::Mat& frame, const cv::Mat& newGradient) {
+
+		cv::Mat changed;
+		cv::absdiff(newGradient,gradient,changed);
+		cv::threshold(changed,changed,changeThreshold,255,cv::THRESH_BINARY);
+		cv::resize(changed,changed,frame.size(),0,0,cv::INTER_NEAREST);
+		// margin for the boundaries to move
+		cv::dilate(changed,changed,cv::Mat(),cv::Point(-1,-1),(1<<levels)+1);
+
+		std::vector<cv::Point> points;
+		cv::findNonZero(changed,points);
+		changedPixels= static_cast<int>(points.size());
+		if (points.empty())
+			return;
+
+		// the changed pixels become unknown, except the user markers
+		markers.setTo(cv::Scalar(0),changed);
+		if (!seeds.empty())
+			seeds.copyTo(markers,(seeds!=0)&changed);
+
+		// watershed on the bounding box of the changed pixels plus a 2-pixel frame:
+		// cv::watershed overwrites the outer ring of its input with boundaries,
+		// the inner ring of known labels then seeds the flooding
+		cv::Rect box= cv::boundingRect(points);
+		box= cv::Rect(box.x-2,box.y-2,box.width+4,box.height+4) & cv::Rect(0,0,frame.cols,frame.rows);
+		cv::Mat roi= markers(box);
+
+		// the labels of the outer ring are restored inside the image
+		cv::Mat saved= roi.clone();
+		cv::watershed(frame(box),roi);
+		if (box.y > 0)
+			saved.row(0).copyTo(roi.row(0));
+		if (box.y+box.height < frame.rows)
+			saved.row(roi.rows-1).copyTo(roi.row(roi.rows-1));
+		if (box.x > 0)
+			saved.col(0).copyTo(roi.col(0));
+		if (box.x+box.width < frame.cols)
+			saved.col(roi.cols-1).copyTo(roi.col(roi.cols-1));
+
+		// unknown pixels cut from every seed (e.g. when the changes cover the frame
+		// and there are no user markers) stay unlabeled: the frame is segmented again
+		if (cv::countNonZero(roi==0) > 0)
+			segment(frame);
+	  }
+
   public:
 
+	  WatershedSegmenter() : restart(true), levels(1), changeThreshold(20.0), changedPixels(0) {}
+
 	  void setMarkers(const cv::Mat& markerImage) {
 
 		// Convert to image of ints
 		markerImage.convertTo(markers,CV_32S);
+		seeds= markers.clone();
+		restart= true;
+	  }
+
+	  // set the number of pyramid levels of the coarse segmentation (video mode)
+	  // 0 to segment the full size frames only
+	  void setLevels(int n) {
+
+		  levels= n;
+		  restart= true;
+	  }
+
+	  // set the gradient change above which a region is segmented again (video mode)
+	  void setChangeThreshold(double t) {
+
+		  changeThreshold= t;
+	  }
+
+	  // number of pixels segmented again in the last frame
+	  int getChangedPixels() {
+
+		  return changedPixels;
+	  }
+
+	  // Segments a video frame (video mode).
+	  // The first frame after setMarkers is segmented from the markers,
+	  // first at a coarse scale. Each following frame starts from the result
+	  // of the previous frame and floods again only the regions whose gradient
+	  // changed beyond the threshold.
+	  cv::Mat processFrame(const cv::Mat &frame) {
+
+		cv::Mat newGradient;
+		reducedGradient(frame,newGradient);
+
+		if (restart || markers.size() != frame.size() || gradient.size() != newGradient.size()) {
+
+			segment(frame);
+			restart= false;
+
+		} else {
+
+			update(frame,newGradient);
+		}
+
+		gradient= newGradient;
+
+		return markers;
 	  }
 
 	  cv::Mat process(const cv::Mat &image) {
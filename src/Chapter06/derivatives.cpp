@@ -22,6 +22,7 @@ Copyright (C) 2016 Robert Laganiere, www.laganiere.name
 #include <opencv2/imgproc.hpp>
 #include <opencv2/highgui.hpp>
 #include "laplacianZC.h"
+#include "scaleSpace.h"
 
 int main()
 {
@@ -170,6 +171,18 @@ int main()
 	cv::namedWindow("Zero-crossings");
 	cv::imshow("Zero-crossings",255-zeros);
 
+	// Same zero-crossings in a single pass without the float Laplacian
+	int64 time= cv::getTickCount();
+	cv::Mat fusedZeros= laplacian.computeZeroCrossings(image);
+	time= cv::getTickCount()-time;
+	std::cout << "Single pass zero-crossings= " << 1000.0*time/cv::getTickFrequency() << "ms"
+		      << ", different pixels= " << cv::countNonZero(fusedZeros!=zeros) << std::endl;
+
+	// keep only the zero-crossings on strong edges (Sobel norm)
+	fusedZeros= laplacian.computeZeroCrossings(image,0.12f*static_cast<float>(sobmax));
+	cv::namedWindow("Strong zero-crossings");
+	cv::imshow("Strong zero-crossings",255-fusedZeros);
+
 	// Print window pixel values
 	std::cout << "Zero values:\n\n";
 	for (int i=0; i<dx; i++) {
@@ -197,28 +210,25 @@ int main()
 	cv::namedWindow("DoG Image (from pyrdown/pyrup)");
 	cv::imshow("DoG Image (from pyrdown/pyrup)",dogImage);
 
-	// Apply two Gaussian filters
-	cv::Mat gauss05;
-	cv::Mat gauss15;
-	cv::GaussianBlur(image,gauss05,cv::Size(),0.5);
-	cv::GaussianBlur(image,gauss15,cv::Size(),1.5);
-
-	// compute a difference of Gaussians 
-	cv::subtract(gauss15, gauss05, dog, cv::Mat(), CV_16S);
+	// Gaussian filters of sigma 0.5, 1.5, 2.0 and 2.2
+	// each one applied on top of the previous one
+	GaussianScaleSpace scaleSpace;
+	scaleSpace.setOctaves(1);
+	scaleSpace.setInputSigma(0.0);
+	double sigmas[]= { 0.5, 1.5, 2.0, 2.2 };
+	scaleSpace.setSigmas(std::vector<double>(sigmas, sigmas+4));
+	scaleSpace.compute(image);
+
+	// the difference of Gaussians 1.5 and 0.5
+	dog= scaleSpace.getDoG(0,0);
 	dog.convertTo(dogImage,CV_8U,2.0,128);
 
     // Display the DoG image
 	cv::namedWindow("DoG Image");
 	cv::imshow("DoG Image",dogImage);
 
-	// Apply two Gaussian filters
-	cv::Mat gauss20;
-	cv::GaussianBlur(image,gauss20,cv::Size(),2.0);
-	cv::Mat gauss22;
-	cv::GaussianBlur(image,gauss22,cv::Size(),2.2);
-
-	// compute a difference of Gaussians 
-	cv::subtract(gauss22, gauss20, dog, cv::Mat(), CV_32F);
+	// the difference of Gaussians 2.2 and 2.0
+	dog= scaleSpace.getDoG(0,2);
 	dog.convertTo(dogImage,CV_8U,10.0,128);
 
     // Display the DoG image
@@ -0,0 +1,89 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 6 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#include <iostream>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/highgui.hpp>
+
+#include "filterGraph.h"
+
+int main()
+{
+	// Read input image
+	cv::Mat image= cv::imread("boldt.jpg",0);
+	if (!image.data)
+		return 0; 
+
+	// a larger image, for the timings
+	cv::Mat large;
+	cv::resize(image,large,cv::Size(),4,4);
+
+	// the edge map of chapter 7:
+	// smoothing, Sobel norm, threshold and closing
+	FilterGraph graph;
+	graph.addGaussian(cv::Size(5,5),1.5);
+	graph.addSobelMagnitude(3);
+	graph.addThreshold(125,255,cv::THRESH_BINARY_INV);
+	graph.addConvert(CV_8U);
+	graph.addMorphology(cv::MORPH_CLOSE,cv::Mat());
+
+	// one stage after the other on full images
+	cv::Mat blurred, sobelX, sobelY, norm, binary, edges;
+	int64 time= cv::getTickCount();
+	cv::GaussianBlur(large,blurred,cv::Size(5,5),1.5);
+	cv::Sobel(blurred,sobelX,CV_32F,1,0,3);
+	cv::Sobel(blurred,sobelY,CV_32F,0,1,3);
+	cv::magnitude(sobelX,sobelY,norm);
+	cv::threshold(norm,norm,125,255,cv::THRESH_BINARY_INV);
+	norm.convertTo(binary,CV_8U);
+	cv::morphologyEx(binary,edges,cv::MORPH_CLOSE,cv::Mat());
+	time= cv::getTickCount()-time;
+	std::cout << "Image by image= " << 1000.0*time/cv::getTickFrequency() << "ms";
+
+	// the same chain tile by tile
+	cv::Mat tiledEdges;
+	time= cv::getTickCount();
+	graph.apply(large,tiledEdges);
+	time= cv::getTickCount()-time;
+	std::cout << ", tile by tile= " << 1000.0*time/cv::getTickFrequency() << "ms";
+
+	// both results should be identical
+	std::cout << ", different pixels= " << cv::countNonZero(edges!=tiledEdges) << std::endl;
+
+	// tile sizes
+	cv::Size tiles[]= { cv::Size(64,64), cv::Size(256,128), cv::Size(512,512), cv::Size(large.cols,large.rows) };
+	for (int i=0; i<4; i++) {
+
+		graph.setTileSize(tiles[i]);
+		time= cv::getTickCount();
+		graph.apply(large,tiledEdges);
+		time= cv::getTickCount()-time;
+		std::cout << tiles[i].width << "x" << tiles[i].height << " tiles= " 
+			      << 1000.0*time/cv::getTickFrequency() << "ms" << std::endl;
+	}
+
+	// Display the edges of the original image
+	graph.setTileSize(cv::Size(256,128));
+	graph.apply(image,edges);
+	cv::namedWindow("Edges (filter graph)");
+	cv::imshow("Edges (filter graph)",edges);
+
+	cv::waitKey();
+	return 0;
+}
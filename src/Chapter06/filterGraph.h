@@ -0,0 +1,204 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 6 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#if !defined FGRAPH
+#define FGRAPH
+
+#include <vector>
+#include <functional>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "../Chapter05/tileGrid.h"
+
+// One stage of a filter graph:
+// the operation (applied to a tile) and the neighbourhood radius it reads
+struct FilterStage {
+
+	std::function<void(const cv::Mat&, cv::Mat&)> apply;
+	cv::Size halo;
+};
+
+// Tile worker running the stages of a filter graph.
+// Each stage writes into its own buffer, so that the whole chain works on
+// tile-sized images which stay in cache from one stage to the next.
+class FilterTiles {
+
+	const cv::Mat& image;
+	cv::Mat& result;
+	const std::vector<FilterStage>& stages;
+	std::vector<cv::Mat> buffers;  // output of each stage for the current tile
+
+  public:
+
+	FilterTiles(const cv::Mat& image, cv::Mat& result, const std::vector<FilterStage>& stages)
+		: image(image), result(result), stages(stages) {}
+
+	// runs the stages on an extended tile
+	// returns the tile part of the output of the last stage
+	cv::Mat filter(const cv::Rect& tile, const cv::Rect& extended) {
+
+		buffers.resize(stages.size());
+		for (size_t i= 0; i < stages.size(); i++)
+			stages[i].apply(i == 0 ? image(extended) : buffers[i - 1], buffers[i]);
+
+		return buffers.back()(tile - extended.tl());
+	}
+
+	// the result must have been allocated with the type of the chain output
+	void operator()(int, const cv::Rect& tile, const cv::Rect& extended) {
+
+		filter(tile, extended).copyTo(result(tile));
+	}
+};
+
+// A chain of point and neighbourhood operations declared once
+// and then applied tile by tile instead of image by image.
+// Each stage only reads the output of the previous one.
+class FilterGraph {
+
+	std::vector<FilterStage> stages;
+	cv::Size tileSize;
+
+  public:
+
+	// tiles of 256x128 pixels keep a few intermediate images in a 256KB cache
+	FilterGraph() : tileSize(256, 128) {}
+
+	// set the size of the tiles
+	void setTileSize(cv::Size s) {
+
+		tileSize= s;
+	}
+
+	cv::Size getTileSize() const {
+
+		return tileSize;
+	}
+
+	// add any operation at the end of the chain
+	// halo is the radius of the neighbourhood it reads (0 for point operations)
+	void addStage(std::function<void(const cv::Mat&, cv::Mat&)> op, cv::Size halo= cv::Size(0, 0)) {
+
+		FilterStage s= { op, halo };
+		stages.push_back(s);
+	}
+
+	// Gaussian filter
+	// with a zero kernel size, the largest size used by cv::GaussianBlur is assumed
+	void addGaussian(cv::Size ksize, double sigma) {
+
+		int n= cvRound(sigma*8 + 1) | 1;
+		cv::Size halo(ksize.width > 0 ? ksize.width/2 : n/2, ksize.height > 0 ? ksize.height/2 : n/2);
+		addStage([=](const cv::Mat& in, cv::Mat& out) { cv::GaussianBlur(in, out, ksize, sigma); }, halo);
+	}
+
+	// Sobel derivative (a ksize of -1 is the Scharr filter)
+	void addSobel(int ddepth, int dx, int dy, int ksize= 3, double scale= 1, double delta= 0) {
+
+		int r= ksize > 0 ? ksize/2 : 1;
+		addStage([=](const cv::Mat& in, cv::Mat& out) { cv::Sobel(in, out, ddepth, dx, dy, ksize, scale, delta); },
+			     cv::Size(r, r));
+	}
+
+	// Sobel gradient norm as a float image
+	// (L1 or L2 norm, as computed by EdgeDetector)
+	void addSobelMagnitude(int ksize= 3, bool l1= false) {
+
+		int r= ksize > 0 ? ksize/2 : 1;
+		addStage([=](const cv::Mat& in, cv::Mat& out) {
+
+			cv::Mat gy;
+			cv::Sobel(in, out, CV_32F, 1, 0, ksize);
+			cv::Sobel(in, gy, CV_32F, 0, 1, ksize);
+			if (l1)
+				out= cv::abs(out) + cv::abs(gy);
+			else
+				cv::magnitude(out, gy, out);
+
+		}, cv::Size(r, r));
+	}
+
+	// threshold (cv::THRESH_* type)
+	void addThreshold(double thresh, double maxval, int type) {
+
+		addStage([=](const cv::Mat& in, cv::Mat& out) { cv::threshold(in, out, thresh, maxval, type); });
+	}
+
+	// conversion to another depth with scale and offset
+	void addConvert(int depth, double alpha= 1, double beta= 0) {
+
+		addStage([=](const cv::Mat& in, cv::Mat& out) { in.convertTo(out, depth, alpha, beta); });
+	}
+
+	// morphological operation (cv::MORPH_*) with a centered element
+	void addMorphology(int op, const cv::Mat& element, int iterations= 1) {
+
+		// an empty element is a 3x3 square
+		cv::Size size= element.empty() ? cv::Size(3, 3) : element.size();
+		addStage([=](const cv::Mat& in, cv::Mat& out) {
+			cv::morphologyEx(in, out, op, element, cv::Point(-1, -1), iterations); },
+			morphologyHalo(op, size, iterations));
+	}
+
+	void clear() {
+
+		stages.clear();
+	}
+
+	// halo of the graph: the stages read each other's output,
+	// so their neighbourhoods add up
+	cv::Size getHalo() const {
+
+		cv::Size halo(0, 0);
+		for (size_t i= 0; i < stages.size(); i++) {
+
+			halo.width+= stages[i].halo.width;
+			halo.height+= stages[i].halo.height;
+		}
+
+		return halo;
+	}
+
+	// applies the chain to an image
+	// the result has the type of the output of the last stage
+	void apply(const cv::Mat& image, cv::Mat& result) {
+
+		CV_Assert(!stages.empty());
+
+		cv::Mat input= image;
+		if (result.data == image.data)
+			input= image.clone();
+
+		TileGrid grid(image.size(), tileSize, getHalo());
+		FilterTiles tiles(input, result, stages);
+
+		// the first tile gives the type of the result;
+		// it is filtered by a copy such that the buffers of the
+		// prototype passed to the parallel loop stay empty
+		FilterTiles worker(tiles);
+		cv::Mat first= worker.filter(grid.tile(0), grid.extended(0));
+		result.create(image.size(), first.type());
+		first.copyTo(result(grid.tile(0)));
+
+		forEachTile(grid, tiles, 1);
+	}
+};
+
+#endif
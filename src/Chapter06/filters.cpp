@@ -21,6 +21,9 @@ Copyright (C) 2016 Robert Laganiere, www.laganiere.name
 #include <opencv2/imgproc.hpp>
 #include <opencv2/highgui.hpp>
 
+#include "scaleSpace.h"
+#include "medianFilter.h"
+
 int main()
 {
 	// Read input image
@@ -147,6 +150,38 @@ int main()
 	cv::namedWindow("Median filtered Image");
 	cv::imshow("Median filtered Image",result);
 
+	// Median filters of larger sizes in constant time
+	ConstantTimeMedian median;
+	cv::Mat fastResult;
+	int64 time;
+	int sizes[]= { 5, 15, 31 };
+	for (int i=0; i<3; i++) {
+
+		time= cv::getTickCount();
+		cv::medianBlur(image,result,sizes[i]);
+		time= cv::getTickCount()-time;
+		std::cout << sizes[i] << "x" << sizes[i] << " medianBlur= " 
+			      << 1000.0*time/cv::getTickFrequency() << "ms";
+
+		median.setSize(sizes[i]);
+		time= cv::getTickCount();
+		median.apply(image,fastResult);
+		time= cv::getTickCount()-time;
+		std::cout << ", constant time= " << 1000.0*time/cv::getTickFrequency() << "ms";
+
+		// both results should be identical
+		std::cout << ", different pixels= " << cv::countNonZero(result!=fastResult) << std::endl;
+	}
+
+	// also on color images
+	cv::Mat color= cv::imread("boldt.jpg");
+	median.setSize(15);
+	median.apply(color,fastResult);
+
+    // Display the filtered image
+	cv::namedWindow("15x15 Median filtered Image");
+	cv::imshow("15x15 Median filtered Image",fastResult);
+
 	// Reduce by 4 the size of the image (the wrong way)
 	image= cv::imread("boldt.jpg",0);
 	cv::Mat reduced(image.rows / 4, image.cols / 4, CV_8U);
@@ -196,20 +231,20 @@ int main()
 	cv::namedWindow("Bilinear resizing");
 	cv::imshow("Bilinear resizing", newImage);
 
-	// Creating an image pyramid
-	cv::Mat pyramid(image.rows, image.cols + image.cols/2 + image.cols/4 + image.cols/8, CV_8U, cv::Scalar(255));
-	image.copyTo(pyramid(cv::Rect(0, 0, image.cols, image.rows)));
-
-	cv::pyrDown(image, reduced); // reduce image size by half
-	reduced.copyTo(pyramid(cv::Rect(image.cols, image.rows/2, image.cols/2, image.rows/2)));
-	cv::pyrDown(reduced, reduced2); // reduce image size by another half
-	reduced2.copyTo(pyramid(cv::Rect(image.cols + image.cols/2, image.rows - image.rows/4, image.cols/4, image.rows/4)));
-	cv::pyrDown(reduced2, reduced); // reduce image size by another half
-	reduced.copyTo(pyramid(cv::Rect(image.cols + image.cols/2 + image.cols/4, image.rows - image.rows/8, image.cols/8, image.rows/8)));
-
-    // Display the pyramid
+	// Creating an image pyramid of 4 octaves
+	// the image is already blurred, each octave is blurred
+	// by a sigma of 1 (as with cv::pyrDown) before being reduced by half
+	GaussianScaleSpace scaleSpace;
+	scaleSpace.setOctaves(4);
+	scaleSpace.setSigmas(std::vector<double>(1, 1.0));
+	scaleSpace.setInputSigma(1.75);
+	scaleSpace.setDepth(CV_8U);
+	scaleSpace.setDoG(false);
+	scaleSpace.compute(image);
+
+    // Display the pyramid (the octaves are stored side by side)
 	cv::namedWindow("Pyramid of images");
-	cv::imshow("Pyramid of images", pyramid);
+	cv::imshow("Pyramid of images", scaleSpace.getMosaic(0));
 
 	cv::waitKey();
 	return 0;
@@ -19,8 +19,113 @@
 #if !defined LAPLACEZC
 #define LAPLACEZC
 
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
 #include <opencv2/core/core.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+
+// Computes the Laplacian of bands of rows and detects its zero-crossings
+// while the band is in cache. A pixel is a zero-crossing if its Laplacian
+// is not positive and one of its 8 neighbours is positive (as with
+// getZeroCrossings). When minStrength is positive, the L1 norm of the
+// 3x3 Sobel gradient at the pixel must also be at least minStrength.
+class ZeroCrossingBands : public cv::ParallelLoopBody {
+
+	const cv::Mat& image;
+	cv::Mat& zeros;
+	int aperture;
+	float minStrength;
+	int bandHeight;
+
+  public:
+
+	ZeroCrossingBands(const cv::Mat& image, cv::Mat& zeros, int aperture, float minStrength, int bandHeight)
+		: image(image), zeros(zeros), aperture(aperture), minStrength(minStrength), bandHeight(bandHeight) {}
+
+	void operator()(const cv::Range& range) const {
+
+		int nc= image.cols;
+		cv::Mat laplace;             // Laplacian of the band and of its 2 neighbouring rows
+		cv::Mat gradX, gradY;        // Sobel derivatives of the same rows
+		std::vector<float> rowMax(nc); // vertical maximum of 3 Laplacian rows
+		std::vector<float> grad(nc, 0.0f); // gradient norm of the current row (0 if not needed)
+
+		for (int band= range.start; band < range.end; band++) {
+
+			int y0= band*bandHeight;
+			int y1= std::min(y0 + bandHeight, image.rows);
+			int top= std::max(y0 - 1, 0);
+			int bottom= std::min(y1 + 1, image.rows);
+
+			// the band is a region of the image:
+			// the rows above and below it are used by the filter
+			cv::Laplacian(image.rowRange(top, bottom), laplace, CV_32F, aperture);
+			if (minStrength > 0.0f) {
+				cv::Sobel(image.rowRange(top, bottom), gradX, CV_32F, 1, 0);
+				cv::Sobel(image.rowRange(top, bottom), gradY, CV_32F, 0, 1);
+			}
+
+			for (int y= y0; y < y1; y++) {
+
+				const float* previous= laplace.ptr<float>(std::max(y - 1, 0) - top);
+				const float* current= laplace.ptr<float>(y - top);
+				const float* next= laplace.ptr<float>(std::min(y + 1, image.rows - 1) - top);
+				float* m= rowMax.data();
+				float* g= grad.data();
+				uchar* out= zeros.ptr<uchar>(y);
+
+				int x= 0;
+#if CV_SIMD128
+				for (; x <= nc - 4; x+= 4)
+					cv::v_store(m + x, cv::v_max(cv::v_load(previous + x), cv::v_max(cv::v_load(current + x), cv::v_load(next + x))));
+#endif
+				for (; x < nc; x++)
+					m[x]= std::max(previous[x], std::max(current[x], next[x]));
+
+				if (minStrength > 0.0f) {
+
+					const float* dx= gradX.ptr<float>(y - top);
+					const float* dy= gradY.ptr<float>(y - top);
+					for (x= 0; x < nc; x++)
+						g[x]= std::abs(dx[x]) + std::abs(dy[x]);
+				}
+
+				// one pixel at a time
+				auto pixel= [&](int x) {
+
+					float v= std::max(m[std::max(x - 1, 0)], std::max(m[x], m[std::min(x + 1, nc - 1)]));
+					float c= current[x];
+					out[x]= (c <= 0.0f && v > 0.0f && g[x] >= minStrength) ? 255 : 0;
+				};
+
+				pixel(0);
+				x= 1;
+#if CV_SIMD128
+				const cv::v_float32x4 zero= cv::v_setzero_f32(), strength= cv::v_setall_f32(minStrength);
+				const cv::v_int32x4 white= cv::v_setall_s32(255);
+
+				// 8 pixels at a time
+				for (; x <= nc - 9; x+= 8) {
+
+					cv::v_float32x4 v0= cv::v_max(cv::v_load(m + x - 1), cv::v_max(cv::v_load(m + x), cv::v_load(m + x + 1)));
+					cv::v_float32x4 v1= cv::v_max(cv::v_load(m + x + 3), cv::v_max(cv::v_load(m + x + 4), cv::v_load(m + x + 5)));
+					cv::v_float32x4 c0= cv::v_load(current + x);
+					cv::v_float32x4 c1= cv::v_load(current + x + 4);
+
+					cv::v_int32x4 z0= cv::v_reinterpret_as_s32((c0 <= zero) & (v0 > zero) & (cv::v_load(g + x) >= strength)) & white;
+					cv::v_int32x4 z1= cv::v_reinterpret_as_s32((c1 <= zero) & (v1 > zero) & (cv::v_load(g + x + 4) >= strength)) & white;
+					cv::v_pack_u_store(out + x, cv::v_pack(z0, z1));
+				}
+#endif
+				for (; x < nc; x++)
+					pixel(x);
+			}
+		}
+	}
+};
 
 class LaplacianZC {
 
@@ -31,9 +136,12 @@ class LaplacianZC {
 	  // Aperture size of the laplacian kernel
 	  int aperture;
 
+	  // number of rows processed together by computeZeroCrossings
+	  int bandHeight;
+
   public:
 
-	  LaplacianZC() : aperture(3) {}
+	  LaplacianZC() : aperture(3), bandHeight(32) {}
 
 	  // Set the aperture size of the kernel
 	  void setAperture(int a) {
@@ -98,6 +206,31 @@ class LaplacianZC {
 		  // return the zero-crossing contours
 		  return dilated-binary;
 	  }
+
+	  // Set the number of rows of the bands processed in parallel
+	  // by computeZeroCrossings
+	  void setBandHeight(int h) {
+
+		  bandHeight= std::max(h, 1);
+	  }
+
+	  // Compute a binary image of the zero-crossings of the Laplacian
+	  // of an image in a single parallel pass, without storing the Laplacian.
+	  // Same result as getZeroCrossings(computeLaplacian(image)) when
+	  // minStrength is 0; otherwise only the zero-crossings where the L1 norm
+	  // of the Sobel gradient reaches minStrength are kept (weak edges are removed)
+	  cv::Mat computeZeroCrossings(const cv::Mat& image, float minStrength= 0.0f) {
+
+		  CV_Assert(image.type() == CV_8UC1);
+
+		  cv::Mat zeros(image.size(), CV_8U);
+		  int nBands= (image.rows + bandHeight - 1)/bandHeight;
+
+		  cv::parallel_for_(cv::Range(0, nBands),
+			  ZeroCrossingBands(image, zeros, aperture, minStrength, bandHeight));
+
+		  return zeros;
+	  }
 };
 
 
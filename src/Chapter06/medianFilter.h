@@ -0,0 +1,219 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 6 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#if !defined MFILTER
+#define MFILTER
+
+#include <vector>
+#include <algorithm>
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+
+// h+= add over n bins
+inline void histogramAdd(ushort* h, const ushort* add, int n) {
+
+	int i= 0;
+#if CV_SIMD128
+	for (; i <= n - 8; i+= 8)
+		cv::v_store(h + i, cv::v_load(h + i) + cv::v_load(add + i));
+#endif
+	for (; i < n; i++)
+		h[i]= static_cast<ushort>(h[i] + add[i]);
+}
+
+// h+= add - sub over n bins
+// 16-bit additions saturate, so add is summed first:
+// the counts never exceed 65535 since sub is included in h
+inline void histogramUpdate(ushort* h, const ushort* add, const ushort* sub, int n) {
+
+	int i= 0;
+#if CV_SIMD128
+	for (; i <= n - 8; i+= 8)
+		cv::v_store(h + i, (cv::v_load(h + i) + cv::v_load(add + i)) - cv::v_load(sub + i));
+#endif
+	for (; i < n; i++)
+		h[i]= static_cast<ushort>(h[i] + add[i] - sub[i]);
+}
+
+// Median filtering of bands of rows.
+// Each band keeps one histogram per column (and channel)
+// of the pixels of the window height; the window histogram then slides
+// along the row by adding one column histogram and removing another.
+// Histograms have 256 fine bins and 16 coarse bins to find the median quickly.
+class MedianBands : public cv::ParallelLoopBody {
+
+	const cv::Mat& src;
+	cv::Mat& dst;
+	int radius;
+	int bandHeight;
+
+	// rank of the median in the window, the first value whose cumulative count exceeds it
+	static uchar median(const ushort* fine, const ushort* coarse, int rank) {
+
+		int s= 0, k= 0;
+		while (s + coarse[k] <= rank)
+			s+= coarse[k++];
+
+		int v= k*16;
+		while (s + fine[v] <= rank)
+			s+= fine[v++];
+
+		return static_cast<uchar>(v);
+	}
+
+  public:
+
+	MedianBands(const cv::Mat& src, cv::Mat& dst, int radius, int bandHeight)
+		: src(src), dst(dst), radius(radius), bandHeight(bandHeight) {}
+
+	void operator()(const cv::Range& range) const {
+
+		int cn= src.channels();
+		int cols= src.cols;
+		int rows= src.rows;
+		int n= cols*cn;
+		int size= 2*radius + 1;
+		int rank= size*size/2;
+
+		// column histograms of the band
+		std::vector<ushort> fine(n*256), coarse(n*16);
+		// window histograms
+		std::vector<ushort> kfine(256), kcoarse(16);
+
+		// border pixels are replicated as with cv::medianBlur
+		auto row= [&](int y) { return src.ptr<uchar>(std::min(std::max(y, 0), rows - 1)); };
+		auto col= [&](int x) { return std::min(std::max(x, 0), cols - 1); };
+
+		for (int b= range.start; b < range.end; b++) {
+
+			int y0= b*bandHeight;
+			int y1= std::min(y0 + bandHeight, rows);
+
+			// column histograms of the window of the first row
+			std::fill(fine.begin(), fine.end(), ushort(0));
+			std::fill(coarse.begin(), coarse.end(), ushort(0));
+			for (int y= y0 - radius; y <= y0 + radius; y++) {
+
+				const uchar* in= row(y);
+				for (int i= 0; i < n; i++) {
+
+					fine[i*256 + in[i]]++;
+					coarse[i*16 + (in[i] >> 4)]++;
+				}
+			}
+
+			for (int y= y0; y < y1; y++) {
+
+				// slides the column histograms down by one row
+				if (y > y0) {
+
+					const uchar* out= row(y - radius - 1);
+					const uchar* in= row(y + radius);
+					for (int i= 0; i < n; i++) {
+
+						fine[i*256 + out[i]]--;
+						coarse[i*16 + (out[i] >> 4)]--;
+						fine[i*256 + in[i]]++;
+						coarse[i*16 + (in[i] >> 4)]++;
+					}
+				}
+
+				uchar* result= dst.ptr<uchar>(y);
+				for (int c= 0; c < cn; c++) {
+
+					// window histogram of the first pixel
+					std::fill(kfine.begin(), kfine.end(), ushort(0));
+					std::fill(kcoarse.begin(), kcoarse.end(), ushort(0));
+					for (int x= -radius; x <= radius; x++) {
+
+						int i= col(x)*cn + c;
+						histogramAdd(kfine.data(), &fine[i*256], 256);
+						histogramAdd(kcoarse.data(), &coarse[i*16], 16);
+					}
+					result[c]= median(kfine.data(), kcoarse.data(), rank);
+
+					// slides the window histogram along the row
+					for (int x= 1; x < cols; x++) {
+
+						int add= col(x + radius)*cn + c;
+						int sub= col(x - radius - 1)*cn + c;
+						histogramUpdate(kcoarse.data(), &coarse[add*16], &coarse[sub*16], 16);
+						histogramUpdate(kfine.data(), &fine[add*256], &fine[sub*256], 256);
+						result[x*cn + c]= median(kfine.data(), kcoarse.data(), rank);
+					}
+				}
+			}
+		}
+	}
+};
+
+// Median filter in constant time per pixel, whatever the window size
+// (Perreault and Hebert), for 8-bit images of 1 to 4 channels.
+// Same result as cv::medianBlur.
+class ConstantTimeMedian {
+
+	int size;        // window size
+	int bandHeight;  // height of the bands processed in parallel
+
+  public:
+
+	ConstantTimeMedian(int s= 3) : size(s), bandHeight(64) {}
+
+	// set the (odd) size of the square window
+	// 16-bit histograms limit it to 255
+	void setSize(int s) {
+
+		CV_Assert(s % 2 == 1 && s <= 255);
+		size= s;
+	}
+
+	int getSize() const {
+
+		return size;
+	}
+
+	// set the height of the bands of rows filtered in parallel
+	// each band starts with the histograms of a full window
+	void setBandHeight(int h) {
+
+		CV_Assert(h > 0);
+		bandHeight= h;
+	}
+
+	int getBandHeight() const {
+
+		return bandHeight;
+	}
+
+	// filters an 8-bit image of 1 to 4 channels
+	void apply(const cv::Mat& image, cv::Mat& result) {
+
+		CV_Assert(image.depth() == CV_8U && image.channels() <= 4);
+
+		cv::Mat input= image;
+		if (result.data == image.data)
+			input= image.clone();
+		result.create(image.size(), image.type());
+
+		int bands= (image.rows + bandHeight - 1)/bandHeight;
+		cv::parallel_for_(cv::Range(0, bands), MedianBands(input, result, size/2, bandHeight));
+	}
+};
+
+#endif
@@ -0,0 +1,101 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 6 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#include <iostream>
+#include <algorithm>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/highgui.hpp>
+
+#include "recursiveFilters.h"
+
+int main()
+{
+	// Read input image
+	cv::Mat image= cv::imread("boldt.jpg",0);
+	if (!image.data)
+		return 0; 
+
+	cv::Mat fimage;
+	image.convertTo(fimage,CV_32F);
+
+	int64 time;
+	double maxDiff, meanDiff;
+	cv::Mat fir, iir, diff;
+
+	// Gaussian filters of increasing sigma
+	RecursiveGaussian gaussian;
+	double sigmas[]= { 2.0, 5.0, 10.0, 20.0, 40.0 };
+	for (int i=0; i<5; i++) {
+
+		time= cv::getTickCount();
+		cv::GaussianBlur(fimage,fir,cv::Size(),sigmas[i]);
+		time= cv::getTickCount()-time;
+		std::cout << "sigma= " << sigmas[i] << ": GaussianBlur= " << 1000.0*time/cv::getTickFrequency() << "ms";
+
+		gaussian.setSigma(sigmas[i]);
+		time= cv::getTickCount();
+		gaussian.apply(fimage,iir);
+		time= cv::getTickCount()-time;
+		std::cout << ", recursive= " << 1000.0*time/cv::getTickFrequency() << "ms";
+
+		// accuracy away from the borders (not handled the same way)
+		int margin= std::min(static_cast<int>(3*sigmas[i]), image.rows/4);
+		cv::Rect interior(margin,margin,image.cols-2*margin,image.rows-2*margin);
+		cv::absdiff(fir(interior),iir(interior),diff);
+		cv::minMaxLoc(diff,0,&maxDiff);
+		meanDiff= cv::mean(diff)[0];
+		std::cout << ", max error= " << maxDiff << ", mean error= " << meanDiff << std::endl;
+	}
+
+	// mean filters of increasing size
+	RunningBox box;
+	int sizes[]= { 5, 21, 51, 101 };
+	for (int i=0; i<4; i++) {
+
+		time= cv::getTickCount();
+		cv::blur(image,fir,cv::Size(sizes[i],sizes[i]));
+		time= cv::getTickCount()-time;
+		std::cout << sizes[i] << "x" << sizes[i] << ": blur= " << 1000.0*time/cv::getTickFrequency() << "ms";
+
+		box.setSize(cv::Size(sizes[i],sizes[i]));
+		time= cv::getTickCount();
+		box.apply(image,iir);
+		time= cv::getTickCount()-time;
+		std::cout << ", running sums= " << 1000.0*time/cv::getTickFrequency() << "ms";
+
+		// both should be identical up to rounding
+		cv::absdiff(fir,iir,diff);
+		cv::minMaxLoc(diff,0,&maxDiff);
+		std::cout << ", max difference= " << maxDiff << std::endl;
+	}
+
+	// background normalization with a large Gaussian
+	cv::Mat background, normalized;
+	gaussian.setSigma(25.0);
+	gaussian.apply(fimage,background);
+	cv::divide(fimage,background+1.0f,normalized,128.0,CV_8U);
+
+	cv::namedWindow("Background (sigma=25)");
+	cv::imshow("Background (sigma=25)",background/255.0f);
+	cv::namedWindow("Normalized image");
+	cv::imshow("Normalized image",normalized);
+
+	cv::waitKey();
+	return 0;
+}
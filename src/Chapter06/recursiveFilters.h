@@ -0,0 +1,447 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 6 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#if !defined RFILTERS
+#define RFILTERS
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+
+// Young-van Vliet recursion (causal then anticausal) applied to n positions
+// of width independent values; position i starts at data + i*step.
+// b holds the normalized coefficients B, b1, b2, b3 and m the 3x3 matrix
+// of Triggs and Sdika giving the exact anticausal initial values
+// when the border values are replicated.
+// edge is a buffer of 3*width values.
+inline void youngVanVliet(float* data, int n, size_t step, int width,
+	                      const float* b, const float* m, float* edge) {
+
+	float* first= edge;            // first input, then anticausal values beyond the end
+	float* last= edge + width;     // last input
+	float* beyond= edge + 2*width; // second anticausal value beyond the end
+
+	// causal pass
+	std::copy(data, data + width, first);
+	std::copy(data + (n - 1)*step, data + (n - 1)*step + width, last);
+	for (int i= 0; i < n; i++) {
+
+		float* p= data + i*step;
+		const float* p1= i > 0 ? p - step : first;
+		const float* p2= i > 1 ? p - 2*step : first;
+		const float* p3= i > 2 ? p - 3*step : first;
+
+		int j= 0;
+#if CV_SIMD128
+		cv::v_float32x4 vb0= cv::v_setall_f32(b[0]), vb1= cv::v_setall_f32(b[1]);
+		cv::v_float32x4 vb2= cv::v_setall_f32(b[2]), vb3= cv::v_setall_f32(b[3]);
+		for (; j <= width - 4; j+= 4)
+			cv::v_store(p + j, vb0*cv::v_load(p + j) + vb1*cv::v_load(p1 + j) +
+				               vb2*cv::v_load(p2 + j) + vb3*cv::v_load(p3 + j));
+#endif
+		for (; j < width; j++)
+			p[j]= b[0]*p[j] + b[1]*p1[j] + b[2]*p2[j] + b[3]*p3[j];
+	}
+
+	// anticausal initial values
+	float* pn= data + (n - 1)*step;
+	const float* pn1= n > 1 ? pn - step : first;
+	const float* pn2= n > 2 ? pn - 2*step : first;
+	for (int j= 0; j < width; j++) {
+
+		float d0= pn[j] - last[j], d1= pn1[j] - last[j], d2= pn2[j] - last[j];
+		float y0= last[j] + b[0]*(m[0]*d0 + m[1]*d1 + m[2]*d2);
+		float y1= last[j] + b[0]*(m[3]*d0 + m[4]*d1 + m[5]*d2);
+		float y2= last[j] + b[0]*(m[6]*d0 + m[7]*d1 + m[8]*d2);
+		pn[j]= y0;
+		first[j]= y1;
+		beyond[j]= y2;
+	}
+
+	// anticausal pass
+	for (int i= n - 2; i >= 0; i--) {
+
+		float* p= data + i*step;
+		const float* p1= p + step;
+		const float* p2= i + 2 < n ? p + 2*step : first;
+		const float* p3= i + 3 < n ? p + 3*step : (i + 3 == n ? first : beyond);
+
+		int j= 0;
+#if CV_SIMD128
+		cv::v_float32x4 vb0= cv::v_setall_f32(b[0]), vb1= cv::v_setall_f32(b[1]);
+		cv::v_float32x4 vb2= cv::v_setall_f32(b[2]), vb3= cv::v_setall_f32(b[3]);
+		for (; j <= width - 4; j+= 4)
+			cv::v_store(p + j, vb0*cv::v_load(p + j) + vb1*cv::v_load(p1 + j) +
+				               vb2*cv::v_load(p2 + j) + vb3*cv::v_load(p3 + j));
+#endif
+		for (; j < width; j++)
+			p[j]= b[0]*p[j] + b[1]*p1[j] + b[2]*p2[j] + b[3]*p3[j];
+	}
+}
+
+// Horizontal recursive Gaussian pass over groups of 4 rows.
+// The 4 rows are interleaved such that they are filtered together
+// in the SIMD lanes.
+class RecursiveRows : public cv::ParallelLoopBody {
+
+	const cv::Mat& src;
+	cv::Mat& dst;       // CV_32F
+	const float* b;
+	const float* m;
+
+  public:
+
+	RecursiveRows(const cv::Mat& src, cv::Mat& dst, const float* b, const float* m)
+		: src(src), dst(dst), b(b), m(m) {}
+
+	void operator()(const cv::Range& range) const {
+
+		int cn= src.channels();
+		int n= src.cols;
+		std::vector<float> buffer(4*cn*n), edge(3*4*cn);
+
+		for (int group= range.start; group < range.end; group++) {
+
+			int y0= 4*group;
+			int k= std::min(4, src.rows - y0); // rows in this group
+			int width= k*cn;
+
+			// interleave the rows
+			for (int r= 0; r < k; r++) {
+
+				cv::Mat row(1, n*cn, CV_32F, dst.ptr<float>(y0 + r));
+				src.row(y0 + r).reshape(1, 1).convertTo(row, CV_32F);
+				const float* in= row.ptr<float>(0);
+				for (int x= 0; x < n; x++)
+					for (int c= 0; c < cn; c++)
+						buffer[x*width + r*cn + c]= in[x*cn + c];
+			}
+
+			youngVanVliet(buffer.data(), n, width, width, b, m, edge.data());
+
+			for (int r= 0; r < k; r++) {
+
+				float* out= dst.ptr<float>(y0 + r);
+				for (int x= 0; x < n; x++)
+					for (int c= 0; c < cn; c++)
+						out[x*cn + c]= buffer[x*width + r*cn + c];
+			}
+		}
+	}
+};
+
+// Vertical recursive Gaussian pass, in place, over stripes of columns.
+class RecursiveColumns : public cv::ParallelLoopBody {
+
+	cv::Mat& image;     // CV_32F
+	const float* b;
+	const float* m;
+	int stripe;         // stripe width in floats
+
+  public:
+
+	RecursiveColumns(cv::Mat& image, const float* b, const float* m, int stripe)
+		: image(image), b(b), m(m), stripe(stripe) {}
+
+	void operator()(const cv::Range& range) const {
+
+		int nc= image.cols*image.channels();
+		std::vector<float> edge(3*stripe);
+
+		for (int s= range.start; s < range.end; s++) {
+
+			int x0= s*stripe;
+			youngVanVliet(image.ptr<float>(0) + x0, image.rows, image.step1(),
+				          std::min(stripe, nc - x0), b, m, edge.data());
+		}
+	}
+};
+
+// Gaussian smoothing in constant time per pixel, whatever the sigma,
+// using the recursive filter of Young and van Vliet (3rd order).
+// Accurate for sigma >= 1, borders are replicated.
+class RecursiveGaussian {
+
+	double sigma;
+	float b[4];    // normalized coefficients B, b1, b2, b3
+	float m[9];    // border matrix of Triggs and Sdika
+	int stripe;    // width of the column stripes of the vertical pass
+
+	void coefficients() {
+
+		double q= sigma >= 2.5 ? 0.98711*sigma - 0.96330
+			                   : 3.97156 - 4.14554*std::sqrt(1.0 - 0.26891*sigma);
+		double q2= q*q, q3= q2*q;
+		double b0= 1.57825 + 2.44413*q + 1.4281*q2 + 0.422205*q3;
+		double b1= 2.44413*q + 2.85619*q2 + 1.26661*q3;
+		double b2= -(1.4281*q2 + 1.26661*q3);
+		double b3= 0.422205*q3;
+
+		b[0]= static_cast<float>(1.0 - (b1 + b2 + b3)/b0);
+		b[1]= static_cast<float>(b1/b0);
+		b[2]= static_cast<float>(b2/b0);
+		b[3]= static_cast<float>(b3/b0);
+
+		double a1= b1/b0, a2= b2/b0, a3= b3/b0;
+		double k= 1.0/((1.0 + a1 - a2 + a3)*(1.0 - a1 - a2 - a3)*(1.0 + a2 + (a1 - a3)*a3));
+		m[0]= static_cast<float>(k*(-a3*a1 + 1.0 - a3*a3 - a2));
+		m[1]= static_cast<float>(k*(a3 + a1)*(a2 + a3*a1));
+		m[2]= static_cast<float>(k*a3*(a1 + a3*a2));
+		m[3]= static_cast<float>(k*(a1 + a3*a2));
+		m[4]= static_cast<float>(-k*(a2 - 1.0)*(a2 + a3*a1));
+		m[5]= static_cast<float>(-k*a3*(a3*a1 + a3*a3 + a2 - 1.0));
+		m[6]= static_cast<float>(k*(a3*a1 + a2 + a1*a1 - a2*a2));
+		m[7]= static_cast<float>(k*(a1*a2 + a3*a2*a2 - a1*a3*a3 - a3*a3*a3 - a3*a2 + a3));
+		m[8]= static_cast<float>(k*a3*(a1 + a3*a2));
+	}
+
+	cv::Mat buffer; // float result
+
+  public:
+
+	RecursiveGaussian(double s= 1.0) : stripe(128) {
+
+		setSigma(s);
+	}
+
+	// set the standard deviation of the Gaussian (at least 1)
+	// below 1, the recursive approximation departs from the Gaussian
+	void setSigma(double s) {
+
+		CV_Assert(s >= 1.0);
+		sigma= s;
+		coefficients();
+	}
+
+	double getSigma() const {
+
+		return sigma;
+	}
+
+	// filters an 8-bit or float image
+	// the result has the type of the input
+	void apply(const cv::Mat& image, cv::Mat& result) {
+
+		CV_Assert(image.depth() == CV_8U || image.depth() == CV_32F);
+
+		buffer.create(image.size(), CV_MAKETYPE(CV_32F, image.channels()));
+
+		// rows in parallel
+		cv::parallel_for_(cv::Range(0, (image.rows + 3)/4), RecursiveRows(image, buffer, b, m));
+
+		// stripes of columns in parallel
+		int nc= image.cols*image.channels();
+		cv::parallel_for_(cv::Range(0, (nc + stripe - 1)/stripe), RecursiveColumns(buffer, b, m, stripe));
+
+		buffer.convertTo(result, image.depth());
+	}
+};
+
+// Horizontal running sums of the rows of an image.
+// S is the pixel type and T the type of the sums (int for 8-bit images, float otherwise).
+template <typename S, typename T>
+class RunningRows : public cv::ParallelLoopBody {
+
+	const cv::Mat& src;
+	cv::Mat& sums;
+	int width;         // window width
+	int anchor;        // window position of the output pixel
+
+  public:
+
+	RunningRows(const cv::Mat& src, cv::Mat& sums, int width, int anchor)
+		: src(src), sums(sums), width(width), anchor(anchor) {}
+
+	void operator()(const cv::Range& range) const {
+
+		int cn= src.channels();
+		int n= src.cols;
+
+		for (int y= range.start; y < range.end; y++) {
+
+			const S* in= src.ptr<S>(y);
+			T* out= sums.ptr<T>(y);
+
+			for (int c= 0; c < cn; c++) {
+
+				// border pixels as with cv::blur
+				auto at= [&](int x) { return static_cast<T>(in[cv::borderInterpolate(x, n, cv::BORDER_REFLECT_101)*cn + c]); };
+
+				T s= 0;
+				for (int x= -anchor; x < width - anchor; x++)
+					s+= at(x);
+				out[c]= s;
+
+				for (int x= 1; x < n; x++) {
+
+					s+= at(x + width - 1 - anchor) - at(x - 1 - anchor);
+					out[x*cn + c]= s;
+				}
+			}
+		}
+	}
+};
+
+// Vertical running sums of the row sums over stripes of columns,
+// scaled into the result.
+template <typename T, typename D>
+class RunningColumns : public cv::ParallelLoopBody {
+
+	const cv::Mat& sums;
+	cv::Mat& dst;
+	int height;        // window height
+	int anchor;        // window position of the output pixel
+	float scale;
+	int stripe;        // stripe width in elements
+
+	static void store(const float* s, float* out, int n, float scale) {
+
+		int x= 0;
+#if CV_SIMD128
+		cv::v_float32x4 k= cv::v_setall_f32(scale);
+		for (; x <= n - 4; x+= 4)
+			cv::v_store(out + x, cv::v_load(s + x)*k);
+#endif
+		for (; x < n; x++)
+			out[x]= s[x]*scale;
+	}
+
+	static void store(const int* s, uchar* out, int n, float scale) {
+
+		int x= 0;
+#if CV_SIMD128
+		cv::v_float32x4 k= cv::v_setall_f32(scale);
+		for (; x <= n - 8; x+= 8) {
+
+			cv::v_int32x4 r0= cv::v_round(cv::v_cvt_f32(cv::v_load(s + x))*k);
+			cv::v_int32x4 r1= cv::v_round(cv::v_cvt_f32(cv::v_load(s + x + 4))*k);
+			cv::v_pack_u_store(out + x, cv::v_pack(r0, r1));
+		}
+#endif
+		for (; x < n; x++)
+			out[x]= cv::saturate_cast<uchar>(s[x]*scale);
+	}
+
+	static void update(T* s, const T* add, const T* sub, int n) {
+
+		int x= 0;
+#if CV_SIMD128
+		for (; x <= n - 4; x+= 4)
+			cv::v_store(s + x, cv::v_load(s + x) + cv::v_load(add + x) - cv::v_load(sub + x));
+#endif
+		for (; x < n; x++)
+			s[x]+= add[x] - sub[x];
+	}
+
+  public:
+
+	RunningColumns(const cv::Mat& sums, cv::Mat& dst, int height, int anchor, float scale, int stripe)
+		: sums(sums), dst(dst), height(height), anchor(anchor), scale(scale), stripe(stripe) {}
+
+	void operator()(const cv::Range& range) const {
+
+		int nc= sums.cols*sums.channels();
+		int nr= sums.rows;
+		std::vector<T> s(stripe);
+
+		for (int k= range.start; k < range.end; k++) {
+
+			int x0= k*stripe;
+			int n= std::min(stripe, nc - x0);
+			auto row= [&](int y) { return sums.ptr<T>(cv::borderInterpolate(y, nr, cv::BORDER_REFLECT_101)) + x0; };
+
+			// sums of the first window
+			std::fill(s.begin(), s.end(), T(0));
+			for (int y= -anchor; y < height - anchor; y++) {
+
+				const T* r= row(y);
+				for (int x= 0; x < n; x++)
+					s[x]+= r[x];
+			}
+			store(s.data(), dst.ptr<D>(0) + x0, n, scale);
+
+			for (int y= 1; y < nr; y++) {
+
+				update(s.data(), row(y + height - 1 - anchor), row(y - 1 - anchor), n);
+				store(s.data(), dst.ptr<D>(y) + x0, n, scale);
+			}
+		}
+	}
+};
+
+// Mean filter in constant time per pixel, whatever the window size,
+// using running sums (same result as cv::blur).
+class RunningBox {
+
+	cv::Size size;
+	int stripe;    // width of the column stripes of the vertical pass
+
+	cv::Mat sums;  // horizontal sums
+
+  public:
+
+	RunningBox(cv::Size s= cv::Size(3, 3)) : size(s), stripe(256) {}
+
+	// set the size of the window
+	void setSize(cv::Size s) {
+
+		size= s;
+	}
+
+	cv::Size getSize() const {
+
+		return size;
+	}
+
+	// filters an 8-bit or float image
+	// the result has the type of the input
+	// (the sums of 8-bit images are exact for windows of less than 8 million pixels)
+	void apply(const cv::Mat& image, cv::Mat& result) {
+
+		CV_Assert(image.depth() == CV_8U || image.depth() == CV_32F);
+
+		cv::Mat input= image;
+		if (result.data == image.data)
+			input= image.clone();
+		result.create(image.size(), image.type());
+
+		int cn= image.channels();
+		int nc= image.cols*cn;
+		float scale= 1.0f/size.area();
+		cv::Range rows(0, image.rows), stripes(0, (nc + stripe - 1)/stripe);
+
+		if (image.depth() == CV_8U) {
+
+			sums.create(image.size(), CV_MAKETYPE(CV_32S, cn));
+			cv::parallel_for_(rows, RunningRows<uchar,int>(input, sums, size.width, size.width/2));
+			cv::parallel_for_(stripes, RunningColumns<int,uchar>(sums, result, size.height, size.height/2, scale, stripe));
+
+		} else {
+
+			sums.create(image.size(), CV_MAKETYPE(CV_32F, cn));
+			cv::parallel_for_(rows, RunningRows<float,float>(input, sums, size.width, size.width/2));
+			cv::parallel_for_(stripes, RunningColumns<float,float>(sums, result, size.height, size.height/2, scale, stripe));
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,234 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 6 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#if !defined SCALESPACE
+#define SCALESPACE
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+// A Gaussian scale space made of octaves (images reduced by a constant factor)
+// each containing levels of increasing blur, with the differences of Gaussians
+// between consecutive levels.
+// Each level is obtained by blurring the previous one with the incremental sigma
+// and each octave starts from a reduced level of the previous octave.
+// All the octaves of a level are stored side by side in a single image
+// (largest at left, bottom aligned) that is reused from one call to the next.
+class GaussianScaleSpace {
+
+  private:
+
+	std::vector<double> sigmas; // blur of each level of an octave (in octave pixels)
+	int nOctaves;               // number of octaves
+	double factor;              // size ratio between consecutive octaves
+	double inputSigma;          // blur already present in the input image
+	int depth;                  // depth of the Gaussian levels
+	bool withDoG;               // if true, differences of Gaussians are computed
+
+	std::vector<cv::Rect> octaves;    // position of each octave in the level images
+	std::vector<cv::Mat> gaussians;   // one image per level, all octaves
+	std::vector<cv::Mat> dogs;        // one image per difference of Gaussians, all octaves
+
+	// computes the size and position of each octave
+	// and allocates the level images
+	void allocate(cv::Size size) {
+
+		octaves.clear();
+		int x= 0;
+		for (int o= 0; o < nOctaves && size.width > 0 && size.height > 0; o++) {
+
+			octaves.push_back(cv::Rect(x, 0, size.width, size.height));
+			x+= size.width;
+			size= cv::Size(cvRound(size.width*factor), cvRound(size.height*factor));
+		}
+
+		// bottom alignment
+		int rows= octaves.empty() ? 0 : octaves[0].height;
+		for (size_t o= 0; o < octaves.size(); o++)
+			octaves[o].y= rows - octaves[o].height;
+
+		// the area not covered by the octaves is zeroed once
+		cv::Size mosaic(x, rows);
+		gaussians.resize(sigmas.size());
+		for (size_t l= 0; l < gaussians.size(); l++)
+			if (gaussians[l].size() != mosaic || gaussians[l].type() != depth)
+				gaussians[l]= cv::Mat::zeros(mosaic, depth);
+
+		dogs.resize(withDoG && sigmas.size() > 1 ? sigmas.size() - 1 : 0);
+		for (size_t l= 0; l < dogs.size(); l++)
+			if (dogs[l].size() != mosaic)
+				dogs[l]= cv::Mat::zeros(mosaic, CV_32F);
+	}
+
+	// applies a Gaussian blur that brings the blur of an image from sigma0 to sigma1
+	void blur(const cv::Mat& src, cv::Mat& dst, double sigma0, double sigma1) const {
+
+		double sigma= std::sqrt(std::max(sigma1*sigma1 - sigma0*sigma0, 0.0));
+
+		// the octaves next to an image are not part of its border
+		if (sigma > 0.01)
+			cv::GaussianBlur(src, dst, cv::Size(), sigma, sigma, cv::BORDER_DEFAULT | cv::BORDER_ISOLATED);
+		else
+			src.copyTo(dst);
+	}
+
+  public:
+
+	GaussianScaleSpace() : nOctaves(4), factor(0.5), inputSigma(0.5), depth(CV_32F), withDoG(true) {
+
+		setLevels(3, 1.6);
+	}
+
+	// set the blur of the levels of an octave
+	// (increasing sigmas, in pixels of the octave)
+	void setSigmas(const std::vector<double>& s) {
+
+		CV_Assert(!s.empty());
+		sigmas= s;
+	}
+
+	// set the levels as in SIFT: s+3 levels from sigma0 to sigma0*2^((s+2)/s)
+	// such that s scales per octave have a difference of Gaussians on each side
+	void setLevels(int s, double sigma0) {
+
+		sigmas.resize(s + 3);
+		for (int i= 0; i < s + 3; i++)
+			sigmas[i]= sigma0*std::pow(2.0, static_cast<double>(i)/s);
+	}
+
+	// set the number of octaves and their size ratio
+	void setOctaves(int n, double f= 0.5) {
+
+		CV_Assert(n > 0 && f > 0.0 && f < 1.0);
+		nOctaves= n;
+		factor= f;
+	}
+
+	// set the blur of the input image (0.5 for a camera image)
+	void setInputSigma(double s) {
+
+		inputSigma= s;
+	}
+
+	// set the depth of the Gaussian levels (CV_32F by default)
+	void setDepth(int d) {
+
+		depth= d;
+	}
+
+	// compute the differences of Gaussians or not
+	void setDoG(bool flag) {
+
+		withDoG= flag;
+	}
+
+	// computes all levels of all octaves of a gray-level image
+	void compute(const cv::Mat& image) {
+
+		CV_Assert(image.channels() == 1);
+		allocate(image.size());
+
+		for (size_t o= 0; o < octaves.size(); o++) {
+
+			cv::Mat first= gaussians[0](octaves[o]);
+			if (o == 0) {
+
+				cv::Mat input;
+				image.convertTo(input, depth);
+				blur(input, first, inputSigma, sigmas[0]);
+
+			} else {
+
+				// the last level blurred by at most sigma0/factor is reduced
+				// then blurred up to sigma0 in the pixels of the new octave
+				size_t l= 0;
+				while (l + 1 < sigmas.size() && sigmas[l + 1] <= sigmas[0]/factor + 1e-6)
+					l++;
+
+				cv::Mat reduced;
+				cv::resize(gaussians[l](octaves[o - 1]), reduced, octaves[o].size(), 0.0, 0.0,
+					       factor == 0.5 ? cv::INTER_NEAREST : cv::INTER_LINEAR);
+				blur(reduced, first, sigmas[l]*factor, sigmas[0]);
+			}
+
+			for (size_t l= 1; l < sigmas.size(); l++) {
+
+				cv::Mat level= gaussians[l](octaves[o]);
+				blur(gaussians[l - 1](octaves[o]), level, sigmas[l - 1], sigmas[l]);
+
+				// while the two levels are in cache
+				if (withDoG) {
+					cv::Mat dog= dogs[l - 1](octaves[o]);
+					cv::subtract(level, gaussians[l - 1](octaves[o]), dog, cv::noArray(), CV_32F);
+				}
+			}
+		}
+	}
+
+	int numberOfOctaves() const {
+
+		return static_cast<int>(octaves.size());
+	}
+
+	int numberOfLevels() const {
+
+		return static_cast<int>(sigmas.size());
+	}
+
+	// Gaussian level of an octave
+	cv::Mat getLevel(int octave, int level) const {
+
+		return gaussians[level](octaves[octave]);
+	}
+
+	// difference between the levels level+1 and level of an octave (CV_32F)
+	cv::Mat getDoG(int octave, int level) const {
+
+		return dogs[level](octaves[octave]);
+	}
+
+	// all octaves of a level side by side
+	const cv::Mat& getMosaic(int level) const {
+
+		return gaussians[level];
+	}
+
+	// all octaves of a difference of Gaussians side by side
+	const cv::Mat& getDoGMosaic(int level) const {
+
+		return dogs[level];
+	}
+
+	// size ratio between an octave and the input image
+	double getScale(int octave) const {
+
+		return static_cast<double>(octaves[octave].width)/octaves[0].width;
+	}
+
+	// blur of a level in input image pixels
+	double getSigma(int octave, int level) const {
+
+		return sigmas[level]/getScale(octave);
+	}
+};
+
+#endif
@@ -0,0 +1,404 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 7 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#if !defined BLOBA
+#define BLOBA
+
+#include <vector>
+#include <climits>
+#include <cfloat>
+#include <algorithm>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+// A connected component and its shape descriptors
+struct Blob {
+
+	int label;            // value in the label image
+	int area;             // number of pixels
+	cv::Rect bbox;        // bounding box
+	cv::Moments moments;  // moments of the pixels (up to order 3)
+	double perimeter;     // pi/4 times the number of pixel sides facing the background,
+	                      // on the outer border and on the border of the holes
+};
+
+// Sums over the runs of a provisional label
+struct RunStats {
+
+	int area;
+	int xmin, ymin, xmax, ymax;
+	int cracks;  // pixel sides between the component and the background
+	double m[10]; // m00 m10 m01 m20 m11 m02 m30 m21 m12 m03
+
+	RunStats() : area(0), xmin(INT_MAX), ymin(INT_MAX), xmax(INT_MIN), ymax(INT_MIN), cracks(0) {
+
+		std::fill(m, m + 10, 0.0);
+	}
+
+	// adds the pixels x0 to x1 of row y
+	void add(int y, int x0, int x1) {
+
+		int n= x1 - x0 + 1;
+		area+= n;
+		xmin= std::min(xmin, x0);
+		xmax= std::max(xmax, x1);
+		ymin= std::min(ymin, y);
+		ymax= std::max(ymax, y);
+		cracks+= 2 + 2*n;
+
+		// sums of x, x^2 and x^3 over the run
+		auto s1= [](double k) { return k*(k + 1)/2; };
+		auto s2= [](double k) { return k*(k + 1)*(2*k + 1)/6; };
+		auto s3= [](double k) { return k*k*(k + 1)*(k + 1)/4; };
+		double sx= s1(x1) - s1(x0 - 1), sxx= s2(x1) - s2(x0 - 1), sxxx= s3(x1) - s3(x0 - 1);
+		double dy= y;
+
+		m[0]+= n;        m[1]+= sx;        m[2]+= n*dy;
+		m[3]+= sxx;      m[4]+= sx*dy;     m[5]+= n*dy*dy;
+		m[6]+= sxxx;     m[7]+= sxx*dy;    m[8]+= sx*dy*dy;    m[9]+= n*dy*dy*dy;
+	}
+
+	RunStats& operator+=(const RunStats& s) {
+
+		area+= s.area;
+		xmin= std::min(xmin, s.xmin);
+		xmax= std::max(xmax, s.xmax);
+		ymin= std::min(ymin, s.ymin);
+		ymax= std::max(ymax, s.ymax);
+		cracks+= s.cracks;
+		for (int i= 0; i < 10; i++)
+			m[i]+= s.m[i];
+
+		return *this;
+	}
+};
+
+// A run of foreground pixels and its provisional label
+struct Run {
+
+	int y, x0, x1;
+	int label;
+};
+
+// Union-find with the smallest label as root
+inline int findRoot(std::vector<int>& parent, int l) {
+
+	int r= l;
+	while (parent[r] != r)
+		r= parent[r];
+	while (parent[l] != r) {
+
+		int next= parent[l];
+		parent[l]= r;
+		l= next;
+	}
+
+	return r;
+}
+
+inline int unite(std::vector<int>& parent, int a, int b) {
+
+	a= findRoot(parent, a);
+	b= findRoot(parent, b);
+	if (a < b)
+		std::swap(a, b);
+	parent[a]= b;
+
+	return b;
+}
+
+// Labels the 8-connected runs of a band of rows
+// and accumulates the statistics of each provisional label.
+// Rows outside the band are ignored (the bands are merged afterwards).
+class BandLabeling : public cv::ParallelLoopBody {
+
+	const cv::Mat& binary;
+	int bandHeight;
+	std::vector<std::vector<Run> >& runs;
+	std::vector<std::vector<int> >& parents;
+	std::vector<std::vector<RunStats> >& stats;
+
+  public:
+
+	BandLabeling(const cv::Mat& binary, int bandHeight, std::vector<std::vector<Run> >& runs,
+		         std::vector<std::vector<int> >& parents, std::vector<std::vector<RunStats> >& stats)
+		: binary(binary), bandHeight(bandHeight), runs(runs), parents(parents), stats(stats) {}
+
+	void operator()(const cv::Range& range) const {
+
+		for (int b= range.start; b < range.end; b++) {
+
+			std::vector<Run>& r= runs[b];
+			std::vector<int>& parent= parents[b];
+			std::vector<RunStats>& s= stats[b];
+			r.clear();
+			parent.clear();
+			s.clear();
+
+			size_t previous= 0, current= 0; // first run of the previous and current rows
+			int y1= std::min((b + 1)*bandHeight, binary.rows);
+
+			for (int y= b*bandHeight; y < y1; y++) {
+
+				const uchar* in= binary.ptr<uchar>(y);
+				previous= current;
+				current= r.size();
+				size_t j= previous;
+
+				for (int x= 0; x < binary.cols; x++) {
+
+					if (!in[x])
+						continue;
+
+					Run run= { y, x, x, -1 };
+					while (x + 1 < binary.cols && in[x + 1])
+						x++;
+					run.x1= x;
+
+					// runs of the previous row touching this one (8-connectivity)
+					while (j < current && r[j].x1 < run.x0 - 1)
+						j++;
+					int overlap= 0;  // pixels with a foreground pixel above
+					for (size_t k= j; k < current && r[k].x0 <= run.x1 + 1; k++) {
+
+						run.label= run.label < 0 ? findRoot(parent, r[k].label) : unite(parent, run.label, r[k].label);
+						overlap+= std::max(std::min(r[k].x1, run.x1) - std::max(r[k].x0, run.x0) + 1, 0);
+					}
+
+					if (run.label < 0) {
+
+						run.label= static_cast<int>(parent.size());
+						parent.push_back(run.label);
+						s.push_back(RunStats());
+					}
+
+					// the sides shared with the previous row are not on the border
+					s[run.label].add(y, run.x0, run.x1);
+					s[run.label].cracks-= 2*overlap;
+					r.push_back(run);
+				}
+			}
+		}
+	}
+};
+
+// Writes the final labels of the runs of each band
+class LabelWriter : public cv::ParallelLoopBody {
+
+	const std::vector<std::vector<Run> >& runs;
+	const std::vector<int>& offsets;  // first global label of each band
+	const std::vector<int>& finalLabels;  // final label of each global label
+	int bandHeight;
+	cv::Mat& labels;
+
+  public:
+
+	LabelWriter(const std::vector<std::vector<Run> >& runs, const std::vector<int>& offsets,
+		        const std::vector<int>& finalLabels, int bandHeight, cv::Mat& labels)
+		: runs(runs), offsets(offsets), finalLabels(finalLabels), bandHeight(bandHeight), labels(labels) {}
+
+	void operator()(const cv::Range& range) const {
+
+		for (int b= range.start; b < range.end; b++) {
+
+			int y1= std::min((b + 1)*bandHeight, labels.rows);
+			labels.rowRange(b*bandHeight, y1).setTo(0);
+
+			for (size_t i= 0; i < runs[b].size(); i++) {
+
+				const Run& run= runs[b][i];
+				int* out= labels.ptr<int>(run.y);
+				std::fill(out + run.x0, out + run.x1 + 1, finalLabels[offsets[b] + run.label]);
+			}
+		}
+	}
+};
+
+// Connected components of a binary image (8-connectivity)
+// with their shape descriptors computed during the labeling.
+// Bands of rows are labeled in parallel and joined at their boundaries.
+// Contours are only extracted for the blobs that are asked for.
+class BlobAnalyzer {
+
+	// the blobs outside these ranges are discarded
+	int minArea, maxArea;
+	double minPerimeter, maxPerimeter;
+
+	int bandHeight;
+
+	// label image of the last analysis
+	cv::Mat labels;
+
+  public:
+
+	BlobAnalyzer() : minArea(0), maxArea(INT_MAX), minPerimeter(0.0), maxPerimeter(DBL_MAX), bandHeight(64) {}
+
+	// Set the range of the blob areas (pixels)
+	void setAreaRange(int amin, int amax) {
+
+		minArea= amin;
+		maxArea= amax;
+	}
+
+	// Set the range of the blob perimeters (see Blob::perimeter);
+	// since holes count, this is not the number of points
+	// of the external contour extracted by cv::findContours
+	void setPerimeterRange(double pmin, double pmax) {
+
+		minPerimeter= pmin;
+		maxPerimeter= pmax;
+	}
+
+	// Set the height of the bands labeled in parallel
+	void setBandHeight(int h) {
+
+		CV_Assert(h > 0);
+		bandHeight= h;
+	}
+
+	// Labels the connected components of non-zero pixels
+	// and returns those within the area and perimeter ranges.
+	// The label image holds the labels of all components.
+	std::vector<Blob> analyze(const cv::Mat& binary) {
+
+		CV_Assert(binary.type() == CV_8U);
+
+		int nBands= (binary.rows + bandHeight - 1)/bandHeight;
+		std::vector<std::vector<Run> > runs(nBands);
+		std::vector<std::vector<int> > parents(nBands);
+		std::vector<std::vector<RunStats> > stats(nBands);
+
+		cv::parallel_for_(cv::Range(0, nBands), BandLabeling(binary, bandHeight, runs, parents, stats));
+
+		// global labels
+		std::vector<int> offsets(nBands + 1, 0);
+		for (int b= 0; b < nBands; b++)
+			offsets[b + 1]= offsets[b] + static_cast<int>(parents[b].size());
+
+		std::vector<int> parent(offsets[nBands]);
+		for (int b= 0; b < nBands; b++)
+			for (size_t l= 0; l < parents[b].size(); l++)
+				parent[offsets[b] + l]= offsets[b] + parents[b][l];
+
+		// joins the last row of a band with the first row of the next one
+		for (int b= 1; b < nBands; b++) {
+
+			int y= b*bandHeight;
+			const std::vector<Run>& above= runs[b - 1];
+			const std::vector<Run>& below= runs[b];
+
+			size_t first= above.size();
+			while (first > 0 && above[first - 1].y == y - 1)
+				first--;
+
+			size_t j= first;
+			for (size_t i= 0; i < below.size() && below[i].y == y; i++) {
+
+				const Run& run= below[i];
+				while (j < above.size() && above[j].x1 < run.x0 - 1)
+					j++;
+				for (size_t k= j; k < above.size() && above[k].x0 <= run.x1 + 1; k++) {
+
+					unite(parent, offsets[b] + run.label, offsets[b - 1] + above[k].label);
+					int overlap= std::min(above[k].x1, run.x1) - std::max(above[k].x0, run.x0) + 1;
+					if (overlap > 0)
+						stats[b][run.label].cracks-= 2*overlap;
+				}
+			}
+		}
+
+		// final labels in scan order and component statistics
+		std::vector<int> finalLabels(parent.size());
+		std::vector<RunStats> components;
+		for (int b= 0; b < nBands; b++) {
+
+			for (size_t l= 0; l < parents[b].size(); l++) {
+
+				int g= offsets[b] + static_cast<int>(l);
+				int r= findRoot(parent, g);
+				if (r == g) {
+
+					finalLabels[g]= static_cast<int>(components.size()) + 1;
+					components.push_back(RunStats());
+				} else {
+
+					finalLabels[g]= finalLabels[r];
+				}
+				components[finalLabels[g] - 1]+= stats[b][l];
+			}
+		}
+
+		labels.create(binary.size(), CV_32S);
+		cv::parallel_for_(cv::Range(0, nBands), LabelWriter(runs, offsets, finalLabels, bandHeight, labels));
+
+		// selected blobs
+		std::vector<Blob> blobs;
+		for (size_t i= 0; i < components.size(); i++) {
+
+			const RunStats& s= components[i];
+			Blob blob;
+			blob.label= static_cast<int>(i) + 1;
+			blob.area= s.area;
+			blob.bbox= cv::Rect(s.xmin, s.ymin, s.xmax - s.xmin + 1, s.ymax - s.ymin + 1);
+			blob.perimeter= s.cracks*CV_PI/4;
+
+			if (blob.area < minArea || blob.area > maxArea ||
+				blob.perimeter < minPerimeter || blob.perimeter > maxPerimeter)
+				continue;
+
+			blob.moments= cv::Moments(s.m[0], s.m[1], s.m[2], s.m[3], s.m[4], s.m[5], s.m[6], s.m[7], s.m[8], s.m[9]);
+			blobs.push_back(blob);
+		}
+
+		return blobs;
+	}
+
+	// Get the label image (CV_32S, 0 for the background)
+	cv::Mat getLabels() const {
+
+		return labels;
+	}
+
+	// Get the external contour of a blob (all its points)
+	std::vector<cv::Point> getContour(const Blob& blob) const {
+
+		// a background border around the blob
+		cv::Mat mask(blob.bbox.height + 2, blob.bbox.width + 2, CV_8U, cv::Scalar(0));
+		cv::Mat inside= mask(cv::Rect(1, 1, blob.bbox.width, blob.bbox.height));
+		cv::compare(labels(blob.bbox), blob.label, inside, cv::CMP_EQ);
+
+		std::vector<std::vector<cv::Point> > contours;
+		cv::findContours(mask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_NONE,
+			             blob.bbox.tl() - cv::Point(1, 1));
+
+		return contours.empty() ? std::vector<cv::Point>() : contours[0];
+	}
+
+	// Get the external contours of a set of blobs
+	std::vector<std::vector<cv::Point> > getContours(const std::vector<Blob>& blobs) const {
+
+		std::vector<std::vector<cv::Point> > contours(blobs.size());
+		for (size_t i= 0; i < blobs.size(); i++)
+			contours[i]= getContour(blobs[i]);
+
+		return contours;
+	}
+};
+
+#endif
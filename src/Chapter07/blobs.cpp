@@ -23,6 +23,8 @@ Copyright (C) 2016 Robert Laganiere, www.laganiere.name
 #include <opencv2/imgproc.hpp>
 #include <opencv2/highgui.hpp>
 
+#include "blobAnalyzer.h"
+
 int main()
 {
 	// Read input binary image
@@ -138,6 +140,60 @@ int main()
 	cv::namedWindow("Some Shape descriptors");
 	cv::imshow("Some Shape descriptors",result);
 
+	// Same descriptors from the connected components
+	image= cv::imread("binaryGroup.bmp",0);
+	BlobAnalyzer analyzer;
+	// the blobs are selected during the labeling, on their perimeter:
+	// a length estimate that also counts the border of the holes,
+	// so the set differs somewhat from the contours of cmin to cmax points kept above
+	analyzer.setPerimeterRange(cmin,cmax);
+	std::vector<Blob> blobs= analyzer.analyze(image);
+	// only the selected blobs are traced
+	std::vector<std::vector<cv::Point> > blobContours= analyzer.getContours(blobs);
+
+	std::cout << "Blobs: " << blobs.size() << " with a perimeter of " << cmin << " to " << cmax << std::endl;
+
+	result.setTo(cv::Scalar(255));
+	cv::drawContours(result,blobContours,-1,0,1);
+	for (size_t i=0; i<blobs.size(); i++) {
+
+		cv::rectangle(result,blobs[i].bbox,0,1);
+		// draw mass center
+		cv::circle(result,
+			cv::Point(blobs[i].moments.m10/blobs[i].moments.m00,blobs[i].moments.m01/blobs[i].moments.m00),
+			2,cv::Scalar(0),2);
+	}
+
+	cv::namedWindow("Blob descriptors");
+	cv::imshow("Blob descriptors",result);
+
+	// Timings on an image with many components
+	cv::Mat many;
+	cv::repeat(image,4,4,many);
+
+	int64 time= cv::getTickCount();
+	cv::Mat copy= many.clone(); // findContours modifies its input
+	cv::findContours(copy,contours,cv::RETR_EXTERNAL,cv::CHAIN_APPROX_NONE);
+	int selected= 0;
+	for (size_t i=0; i<contours.size(); i++) {
+
+		if (contours[i].size() < cmin || contours[i].size() > cmax)
+			continue;
+		cv::boundingRect(contours[i]);
+		cv::moments(contours[i]);
+		selected++;
+	}
+	time= cv::getTickCount()-time;
+	std::cout << selected << " contours of " << contours.size() 
+		      << ": findContours= " << 1000.0*time/cv::getTickFrequency() << "ms";
+
+	time= cv::getTickCount();
+	blobs= analyzer.analyze(many);
+	blobContours= analyzer.getContours(blobs);
+	time= cv::getTickCount()-time;
+	std::cout << ", " << blobs.size() << " blobs"
+		      << ": analyzer= " << 1000.0*time/cv::getTickFrequency() << "ms" << std::endl;
+
 	// New call to findContours but with RETR_LIST flag
 	image= cv::imread("binaryGroup.bmp",0);
 
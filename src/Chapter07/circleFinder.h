@@ -0,0 +1,334 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 7 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#if !defined CIRCLEF
+#define CIRCLEF
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "orientedHough.h"
+
+// Votes for the circle centers along the gradient direction of the edge pixels
+// of bands of rows, each band in its own accumulator (as cv::HoughCircles).
+// The edge pixels of each band are also collected.
+class CenterVotes : public cv::ParallelLoopBody {
+
+	const cv::Mat& edges;
+	const cv::Mat& dx;
+	const cv::Mat& dy;
+	std::vector<cv::Mat>& accumulators;
+	std::vector<std::vector<cv::Point> >& points;
+	double dp;
+	int minRadius, maxRadius;
+
+  public:
+
+	CenterVotes(const cv::Mat& edges, const cv::Mat& dx, const cv::Mat& dy,
+		        std::vector<cv::Mat>& accumulators, std::vector<std::vector<cv::Point> >& points,
+		        double dp, int minRadius, int maxRadius)
+		: edges(edges), dx(dx), dy(dy), accumulators(accumulators), points(points),
+		  dp(dp), minRadius(minRadius), maxRadius(maxRadius) {}
+
+	void operator()(const cv::Range& range) const {
+
+		const int shift= 10, one= 1 << shift;
+		int bands= static_cast<int>(accumulators.size());
+		float idp= static_cast<float>(1.0/dp);
+
+		for (int b= range.start; b < range.end; b++) {
+
+			cv::Mat& acc= accumulators[b];
+			acc.setTo(0);
+			points[b].clear();
+			// cells of the accumulator inside its 1-cell border
+			int cols= acc.cols - 2, rows= acc.rows - 2;
+
+			for (int y= b*edges.rows/bands; y < (b + 1)*edges.rows/bands; y++) {
+
+				const uchar* e= edges.ptr<uchar>(y);
+				const short* gx= dx.ptr<short>(y);
+				const short* gy= dy.ptr<short>(y);
+
+				for (int x= 0; x < edges.cols; x++) {
+
+					if (!e[x] || (gx[x] == 0 && gy[x] == 0))
+						continue;
+
+					float vx= gx[x], vy= gy[x];
+					float mag= std::sqrt(vx*vx + vy*vy);
+					int sx= cvRound(vx*idp*one/mag);
+					int sy= cvRound(vy*idp*one/mag);
+					int x0= cvRound(x*idp*one);
+					int y0= cvRound(y*idp*one);
+
+					// one vote per radius, on both sides of the edge
+					for (int side= 0; side < 2; side++) {
+
+						int x1= x0 + minRadius*sx;
+						int y1= y0 + minRadius*sy;
+
+						for (int r= minRadius; r <= maxRadius; x1+= sx, y1+= sy, r++) {
+
+							int x2= x1 >> shift, y2= y1 >> shift;
+							if (static_cast<unsigned>(x2) >= static_cast<unsigned>(cols) ||
+								static_cast<unsigned>(y2) >= static_cast<unsigned>(rows))
+								break;
+							acc.ptr<int>(y2 + 1)[x2 + 1]++;
+						}
+
+						sx= -sx;
+						sy= -sy;
+					}
+
+					points[b].push_back(cv::Point(x, y));
+				}
+			}
+		}
+	}
+};
+
+// Estimates the radius of a batch of candidate centers in parallel
+// from the histogram of the distances of the edge pixels to each center.
+class RadiusEstimation : public cv::ParallelLoopBody {
+
+	const std::vector<cv::Point>& points;  // edge pixels in scan order
+	const std::vector<int>& rowStart;      // first edge pixel of each row
+	const std::vector<cv::Point2f>& centers;
+	std::vector<cv::Vec3f>& circles;       // center, radius
+	std::vector<int>& support;             // number of edge pixels at that radius
+	float dr;
+	int minRadius, maxRadius;
+
+  public:
+
+	RadiusEstimation(const std::vector<cv::Point>& points, const std::vector<int>& rowStart,
+		             const std::vector<cv::Point2f>& centers, std::vector<cv::Vec3f>& circles,
+		             std::vector<int>& support, float dr, int minRadius, int maxRadius)
+		: points(points), rowStart(rowStart), centers(centers), circles(circles), support(support),
+		  dr(dr), minRadius(minRadius), maxRadius(maxRadius) {}
+
+	void operator()(const cv::Range& range) const {
+
+		int nBins= cvFloor((maxRadius - minRadius)/dr) + 1;
+		std::vector<int> count(nBins);
+		std::vector<float> sum(nBins);
+		int rows= static_cast<int>(rowStart.size()) - 1;
+		float r2min= static_cast<float>(minRadius*minRadius), r2max= static_cast<float>(maxRadius*maxRadius);
+
+		for (int i= range.start; i < range.end; i++) {
+
+			cv::Point2f c= centers[i];
+			std::fill(count.begin(), count.end(), 0);
+			std::fill(sum.begin(), sum.end(), 0.0f);
+
+			// radial histogram of the edge pixels within the largest circle
+			int y0= std::max(cvFloor(c.y - maxRadius), 0), y1= std::min(cvCeil(c.y + maxRadius), rows - 1);
+			for (int y= y0; y <= y1; y++) {
+
+				auto first= points.begin() + rowStart[y], last= points.begin() + rowStart[y + 1];
+				first= std::lower_bound(first, last, cv::Point(cvFloor(c.x - maxRadius), y),
+					[](const cv::Point& a, const cv::Point& b) { return a.x < b.x; });
+
+				float ddy= y - c.y;
+				for (; first != last && first->x <= c.x + maxRadius; ++first) {
+
+					float ddx= first->x - c.x;
+					float d2= ddx*ddx + ddy*ddy;
+					if (d2 < r2min || d2 > r2max)
+						continue;
+
+					float d= std::sqrt(d2);
+					int bin= std::min(static_cast<int>((d - minRadius)/dr), nBins - 1);
+					count[bin]++;
+					sum[bin]+= d;
+				}
+			}
+
+			// the radius with the most edge pixels relative to its circumference
+			int best= -1;
+			for (int bin= 0; bin < nBins; bin++) {
+
+				if (count[bin] == 0)
+					continue;
+				if (best < 0 || count[bin]*(minRadius + (best + 0.5f)*dr) > count[best]*(minRadius + (bin + 0.5f)*dr))
+					best= bin;
+			}
+
+			if (best < 0) {
+
+				support[i]= 0;
+				continue;
+			}
+
+			circles[i]= cv::Vec3f(c.x, c.y, sum[best]/count[best]);
+			support[i]= count[best];
+		}
+	}
+};
+
+// Circle detection with the gradient method of cv::HoughCircles:
+// edge pixels vote for centers along their gradient direction,
+// in parallel bands of rows with separate accumulators,
+// then the radius of each candidate center is estimated in parallel.
+class CircleFinder {
+
+	double dp;         // inverse ratio of the accumulator resolution
+	double minDist;    // minimum distance between two centers
+	double cannyHigh;  // high threshold of the Canny detector (low is half)
+	int minVote;       // minimum number of votes of a center and of edge pixels on its circle
+	int minRadius, maxRadius;
+
+	cv::Mat accumulator;
+	std::vector<cv::Mat> partial;  // one per band
+
+  public:
+
+	CircleFinder() : dp(2), minDist(20), cannyHigh(200), minVote(60), minRadius(0), maxRadius(0) {}
+
+	// Set the inverse ratio of the accumulator resolution
+	// (2 gives an accumulator of half the image size)
+	void setResolution(double ratio) {
+
+		dp= std::max(ratio, 1.0);
+	}
+
+	// Set the minimum distance between two circle centers
+	void setMinDistance(double d) {
+
+		minDist= d;
+	}
+
+	// Set the high threshold of the Canny detector
+	void setCannyThreshold(double t) {
+
+		cannyHigh= t;
+	}
+
+	// Set the minimum number of votes
+	void setMinVote(int minv) {
+
+		minVote= minv;
+	}
+
+	// Set the range of the radii (a zero maximum means the image size)
+	void setRadiusRange(int rmin, int rmax) {
+
+		minRadius= std::max(rmin, 0);
+		maxRadius= rmax;
+	}
+
+	// Detects the circles (x, y, radius) of a gray-level image
+	// sorted by decreasing number of votes of their centers
+	std::vector<cv::Vec3f> findCircles(const cv::Mat& image) {
+
+		CV_Assert(image.type() == CV_8U);
+
+		int rmax= maxRadius > 0 ? maxRadius : std::max(image.rows, image.cols);
+		CV_Assert(rmax >= minRadius);
+
+		cv::Mat edges, dx, dy;
+		cv::Canny(image, edges, std::max(cannyHigh/2, 1.0), cannyHigh);
+		cv::Sobel(image, dx, CV_16S, 1, 0);
+		cv::Sobel(image, dy, CV_16S, 0, 1);
+
+		// center votes
+		int acols= cvCeil(image.cols/dp), arows= cvCeil(image.rows/dp);
+		accumulator.create(arows + 2, acols + 2, CV_32S);
+		partial.resize(std::max(cv::getNumThreads(), 1));
+		for (size_t b= 0; b < partial.size(); b++)
+			partial[b].create(arows + 2, acols + 2, CV_32S);
+		std::vector<std::vector<cv::Point> > bandPoints(partial.size());
+
+		cv::parallel_for_(cv::Range(0, static_cast<int>(partial.size())),
+			CenterVotes(edges, dx, dy, partial, bandPoints, dp, minRadius, rmax));
+		cv::parallel_for_(cv::Range(0, accumulator.rows), VoteReduction(partial, accumulator));
+
+		// edge pixels in scan order, indexed by row
+		std::vector<cv::Point> points;
+		for (size_t b= 0; b < bandPoints.size(); b++)
+			points.insert(points.end(), bandPoints[b].begin(), bandPoints[b].end());
+		std::vector<int> rowStart(image.rows + 1, 0);
+		for (size_t i= 0; i < points.size(); i++)
+			rowStart[points[i].y + 1]++;
+		for (int y= 0; y < image.rows; y++)
+			rowStart[y + 1]+= rowStart[y];
+
+		// local maxima of the accumulator, strongest first
+		std::vector<std::pair<int, cv::Point2f> > peaks;
+		for (int y= 1; y <= arows; y++) {
+
+			const int* previous= accumulator.ptr<int>(y - 1);
+			const int* current= accumulator.ptr<int>(y);
+			const int* next= accumulator.ptr<int>(y + 1);
+
+			for (int x= 1; x <= acols; x++) {
+
+				int v= current[x];
+				if (v > minVote && v > current[x - 1] && v > current[x + 1] && v > previous[x] && v > next[x])
+					peaks.push_back(std::make_pair(v, cv::Point2f(static_cast<float>((x - 1 + 0.5)*dp),
+						                                          static_cast<float>((y - 1 + 0.5)*dp))));
+			}
+		}
+		std::stable_sort(peaks.begin(), peaks.end(),
+			[](const std::pair<int, cv::Point2f>& a, const std::pair<int, cv::Point2f>& b) { return a.first > b.first; });
+
+		std::vector<cv::Point2f> centers(peaks.size());
+		for (size_t i= 0; i < peaks.size(); i++)
+			centers[i]= peaks[i].second;
+
+		// radii of all the candidates at once
+		std::vector<cv::Vec3f> candidates(centers.size());
+		std::vector<int> support(centers.size(), 0);
+		cv::parallel_for_(cv::Range(0, static_cast<int>(centers.size())),
+			RadiusEstimation(points, rowStart, centers, candidates, support, static_cast<float>(dp), minRadius, rmax));
+
+		// circles with enough edge pixels, away from the stronger ones
+		std::vector<cv::Vec3f> circles;
+		double minDist2= minDist*minDist;
+		for (size_t i= 0; i < candidates.size(); i++) {
+
+			if (support[i] <= minVote)
+				continue;
+
+			bool isolated= true;
+			for (size_t j= 0; j < circles.size() && isolated; j++) {
+
+				double ddx= circles[j][0] - candidates[i][0], ddy= circles[j][1] - candidates[i][1];
+				isolated= ddx*ddx + ddy*ddy >= minDist2;
+			}
+
+			if (isolated)
+				circles.push_back(candidates[i]);
+		}
+
+		return circles;
+	}
+
+	// Get the center accumulator of the last detection
+	cv::Mat getAccumulator() const {
+
+		return accumulator;
+	}
+};
+
+#endif
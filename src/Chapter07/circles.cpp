@@ -0,0 +1,126 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 7 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#include <iostream>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/highgui.hpp>
+
+#include "circleFinder.h"
+
+// number of reference circles found by a detection
+// (center within tol and radius within 20%)
+int matches(const std::vector<cv::Vec3f>& reference, const std::vector<cv::Vec3f>& detected, double tol) {
+
+	int n= 0;
+	for (size_t i=0; i<reference.size(); i++) {
+
+		for (size_t j=0; j<detected.size(); j++) {
+
+			double dx= reference[i][0]-detected[j][0];
+			double dy= reference[i][1]-detected[j][1];
+			if (dx*dx+dy*dy < tol*tol && std::abs(reference[i][2]-detected[j][2]) < 0.2*reference[i][2]) {
+				n++;
+				break;
+			}
+		}
+	}
+
+	return n;
+}
+
+// runs and times both detectors with the same parameters
+// returns the circles of both
+void compare(const cv::Mat& image, double dp, double minDist, double canny, int votes, int rmin, int rmax,
+	         std::vector<cv::Vec3f>& hough, std::vector<cv::Vec3f>& finder) {
+
+	int64 time= cv::getTickCount();
+	cv::HoughCircles(image, hough, cv::HOUGH_GRADIENT, dp, minDist, canny, votes, rmin, rmax);
+	time= cv::getTickCount()-time;
+	std::cout << image.cols << "x" << image.rows << ": HoughCircles= " << 1000.0*time/cv::getTickFrequency() 
+		      << "ms (" << hough.size() << " circles)";
+
+	CircleFinder cf;
+	cf.setResolution(dp);
+	cf.setMinDistance(minDist);
+	cf.setCannyThreshold(canny);
+	cf.setMinVote(votes);
+	cf.setRadiusRange(rmin,rmax);
+	time= cv::getTickCount();
+	finder= cf.findCircles(image);
+	time= cv::getTickCount()-time;
+	std::cout << ", CircleFinder= " << 1000.0*time/cv::getTickFrequency() 
+		      << "ms (" << finder.size() << " circles)" << std::endl;
+}
+
+int main()
+{
+	// Read input image
+	cv::Mat image= cv::imread("chariot.jpg",0);
+	if (!image.data)
+		return 0; 
+
+	cv::GaussianBlur(image, image, cv::Size(5, 5), 1.5);
+	std::vector<cv::Vec3f> hough, finder;
+
+	// the parameters of contours.cpp
+	compare(image, 2, 20, 200, 60, 15, 50, hough, finder);
+	std::cout << "  HoughCircles circles also found: " << matches(hough, finder, 10) << "/" << hough.size() << std::endl;
+
+	// Draw the circles (HoughCircles in white, CircleFinder in black)
+	cv::Mat result= cv::imread("chariot.jpg",0);
+	for (size_t i=0; i<hough.size(); i++)
+		cv::circle(result, cv::Point(hough[i][0], hough[i][1]), hough[i][2], cv::Scalar(255), 3);
+	for (size_t i=0; i<finder.size(); i++)
+		cv::circle(result, cv::Point(finder[i][0], finder[i][1]), finder[i][2], cv::Scalar(0), 1);
+
+	cv::namedWindow("Detected Circles");
+	cv::imshow("Detected Circles",result);
+
+	// a larger image (distances and votes are scaled)
+	cv::Mat large;
+	cv::resize(image, large, cv::Size(), 3, 3);
+	compare(large, 2, 60, 200, 180, 45, 150, hough, finder);
+	std::cout << "  HoughCircles circles also found: " << matches(hough, finder, 30) << "/" << hough.size() << std::endl;
+
+	// particles of known position and size
+	cv::Mat particles(1080, 1920, CV_8U, cv::Scalar(40));
+	std::vector<cv::Vec3f> truth;
+	cv::RNG rng(12345);
+	for (int i=0; i<2000 && truth.size()<300; i++) {
+
+		cv::Vec3f c(rng.uniform(40.f, 1880.f), rng.uniform(40.f, 1040.f), rng.uniform(10.f, 30.f));
+		bool apart= true;
+		for (size_t j=0; j<truth.size() && apart; j++)
+			apart= cv::norm(cv::Point2f(c[0]-truth[j][0], c[1]-truth[j][1])) > c[2]+truth[j][2]+10;
+		if (!apart)
+			continue;
+
+		truth.push_back(c);
+		cv::circle(particles, cv::Point(cvRound(c[0]*16), cvRound(c[1]*16)), cvRound(c[2]*16), cv::Scalar(200), -1, cv::LINE_AA, 4);
+	}
+	cv::GaussianBlur(particles, particles, cv::Size(5, 5), 1.5);
+
+	compare(particles, 2, 20, 100, 40, 8, 35, hough, finder);
+	std::cout << "  recall: HoughCircles= " << matches(truth, hough, 3) << "/" << truth.size()
+		      << ", CircleFinder= " << matches(truth, finder, 3) << "/" << truth.size() << std::endl;
+
+	cv::waitKey();
+	return 0;
+}
@@ -24,6 +24,7 @@ Copyright (C) 2016 Robert Laganiere, www.laganiere.name
 
 #include "linefinder.h"
 #include "edgedetector.h"
+#include "orientedHough.h"
 
 #define PI 3.1415926
 
@@ -40,7 +41,16 @@ int main()
 
 	// Compute Sobel
 	EdgeDetector ed;
+	int64 time= cv::getTickCount();
 	ed.computeSobel(image);
+	time= cv::getTickCount()-time;
+	std::cout << "Sobel + cartToPolar= " << 1000.0*time/cv::getTickFrequency() << "ms" << std::endl;
+
+	// same in a single pass (orientation in 2-degree bins)
+	time= cv::getTickCount();
+	ed.computeFusedSobel(image);
+	time= cv::getTickCount()-time;
+	std::cout << "fused Sobel= " << 1000.0*time/cv::getTickFrequency() << "ms" << std::endl;
 
     // Display the Sobel orientation
 	cv::namedWindow("Sobel (orientation)");
@@ -121,6 +131,35 @@ int main()
 	cv::namedWindow("Lines with Hough");
 	cv::imshow("Lines with Hough",result);
 
+	// Hough transform with votes along the gradient orientations only
+	OrientedHough oriented;
+	oriented.setMinVote(50);
+	oriented.setThetaWindow(3);
+	time= cv::getTickCount();
+	cv::HoughLines(contours,lines,1,PI/180,50);
+	time= cv::getTickCount()-time;
+	std::cout << "HoughLines= " << 1000.0*time/cv::getTickFrequency() << "ms (" << lines.size() << " lines)";
+	time= cv::getTickCount();
+	std::vector<cv::Vec2f> orientedLines= oriented.findLines(contours,ed.getSobelOrientationImage());
+	time= cv::getTickCount()-time;
+	std::cout << ", oriented= " << 1000.0*time/cv::getTickFrequency() << "ms (" << orientedLines.size() << " lines)" << std::endl;
+
+	// on a larger frame
+	cv::Mat large, largeContours;
+	cv::resize(image,large,cv::Size(),4,4);
+	cv::Canny(large,largeContours,125,350);
+	ed.computeFusedSobel(large);
+	time= cv::getTickCount();
+	cv::HoughLines(largeContours,lines,1,PI/180,200);
+	time= cv::getTickCount()-time;
+	std::cout << large.cols << "x" << large.rows << " HoughLines= " << 1000.0*time/cv::getTickFrequency() << "ms";
+	oriented.setMinVote(200);
+	time= cv::getTickCount();
+	orientedLines= oriented.findLines(largeContours,ed.getSobelOrientationImage());
+	time= cv::getTickCount()-time;
+	std::cout << ", oriented= " << 1000.0*time/cv::getTickFrequency() << "ms" << std::endl;
+	ed.computeFusedSobel(image);
+
 	// Create LineFinder instance
 	LineFinder ld;
 
@@ -202,6 +241,37 @@ int main()
 	cv::namedWindow("Detected Lines (2)");
 	cv::imshow("Detected Lines (2)",image);
 
+	// Track the lines over a sequence of frames
+	// (the road image shifted a little at each frame)
+	image= cv::imread("road.jpg",0);
+	LineFinder tracker;
+	tracker.setLineLengthAndGap(100,20);
+	tracker.setMinVote(60);
+	tracker.setTracking(3,10,10);
+	double tHough= 0.0, tTracking= 0.0;
+	cv::Mat frame, frameContours;
+	for (int f=0; f<20; f++) {
+
+		frame= image(cv::Rect(f,f/2,image.cols-20,image.rows-10));
+		cv::Canny(frame,frameContours,125,350);
+		ed.computeFusedSobel(frame);
+
+		time= cv::getTickCount();
+		ld.findLines(frameContours);
+		tHough+= cv::getTickCount()-time;
+
+		time= cv::getTickCount();
+		tracker.trackLines(frameContours,ed.getSobelOrientationImage());
+		tTracking+= cv::getTickCount()-time;
+	}
+	std::cout << "20 frames: HoughLinesP= " << 1000.0*tHough/cv::getTickFrequency() 
+		      << "ms, tracking= " << 1000.0*tTracking/cv::getTickFrequency() << "ms" << std::endl;
+
+	frame= frame.clone();
+	tracker.drawDetectedLines(frame);
+	cv::namedWindow("Tracked Lines");
+	cv::imshow("Tracked Lines",frame);
+
 	// Create a Hough accumulator
 	cv::Mat acc(200,180,CV_8U,cv::Scalar(0));
 
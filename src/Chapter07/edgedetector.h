@@ -21,8 +21,145 @@ Copyright (C) 2016 Robert Laganiere, www.laganiere.name
 
 #define PI 3.1415926
 
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
 #include <opencv2/core/core.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+
+// 2-degree orientation bin (0 to 179) of a gradient
+// using the polynomial approximation of cv::fastAtan2
+inline int orientationBin(float gx, float gy) {
+
+	const float p1= 0.9997878412794807f*57.29577951308232f;
+	const float p3= -0.3258083974640975f*57.29577951308232f;
+	const float p5= 0.1555786518463281f*57.29577951308232f;
+	const float p7= -0.04432655554792128f*57.29577951308232f;
+
+	float ax= std::fabs(gx), ay= std::fabs(gy);
+	float c= std::min(ax, ay)/(std::max(ax, ay) + FLT_EPSILON);
+	float c2= c*c;
+	float a= (((p7*c2 + p5)*c2 + p3)*c2 + p1)*c;
+	if (ax < ay) a= 90.0f - a;
+	if (gx < 0.0f) a= 180.0f - a;
+	if (gy < 0.0f) a= 360.0f - a;
+
+	int bin= cvRound(a*0.5f);
+	return bin == 180 ? 0 : bin;
+}
+
+// Computes the 3x3 Sobel derivatives of an 8-bit image, their magnitude
+// and their quantized orientation in a single pass over the image rows.
+// The magnitude is either the L2 norm (CV_32F) or the L1 norm (CV_16U)
+// depending on the type of the magnitude image.
+// Borders are reflected as in cv::Sobel.
+class FusedSobel : public cv::ParallelLoopBody {
+
+	const cv::Mat& image;
+	cv::Mat& magnitude;
+	cv::Mat& orientation; // CV_8U 2-degree bins
+
+  public:
+
+	FusedSobel(const cv::Mat& image, cv::Mat& magnitude, cv::Mat& orientation)
+		: image(image), magnitude(magnitude), orientation(orientation) {}
+
+	void operator()(const cv::Range& range) const {
+
+		int nc= image.cols;
+		bool l1= magnitude.depth() == CV_16U;
+
+		for (int y= range.start; y < range.end; y++) {
+
+			const uchar* r0= image.ptr<uchar>(cv::borderInterpolate(y - 1, image.rows, cv::BORDER_REFLECT_101));
+			const uchar* r1= image.ptr<uchar>(y);
+			const uchar* r2= image.ptr<uchar>(cv::borderInterpolate(y + 1, image.rows, cv::BORDER_REFLECT_101));
+			float* m32= magnitude.ptr<float>(y);
+			ushort* m16= magnitude.ptr<ushort>(y);
+			uchar* ori= orientation.ptr<uchar>(y);
+
+			// one pixel at a time
+			auto pixel= [&](int x) {
+
+				int xl= cv::borderInterpolate(x - 1, nc, cv::BORDER_REFLECT_101);
+				int xr= cv::borderInterpolate(x + 1, nc, cv::BORDER_REFLECT_101);
+				int gx= (r0[xr] - r0[xl]) + 2*(r1[xr] - r1[xl]) + (r2[xr] - r2[xl]);
+				int gy= (r2[xl] + 2*r2[x] + r2[xr]) - (r0[xl] + 2*r0[x] + r0[xr]);
+				float fx= static_cast<float>(gx), fy= static_cast<float>(gy);
+
+				if (l1)
+					m16[x]= static_cast<ushort>(std::abs(gx) + std::abs(gy));
+				else
+					m32[x]= std::sqrt(fx*fx + fy*fy);
+				ori[x]= static_cast<uchar>(orientationBin(fx, fy));
+			};
+
+			pixel(0);
+			int x= 1;
+
+#if CV_SIMD128
+			const cv::v_float32x4 p1= cv::v_setall_f32(0.9997878412794807f*57.29577951308232f);
+			const cv::v_float32x4 p3= cv::v_setall_f32(-0.3258083974640975f*57.29577951308232f);
+			const cv::v_float32x4 p5= cv::v_setall_f32(0.1555786518463281f*57.29577951308232f);
+			const cv::v_float32x4 p7= cv::v_setall_f32(-0.04432655554792128f*57.29577951308232f);
+			const cv::v_float32x4 zero= cv::v_setzero_f32(), half= cv::v_setall_f32(0.5f), eps= cv::v_setall_f32(FLT_EPSILON);
+			const cv::v_float32x4 d90= cv::v_setall_f32(90.0f), d180= cv::v_setall_f32(180.0f), d360= cv::v_setall_f32(360.0f);
+			const cv::v_int32x4 wrap= cv::v_setall_s32(180), first= cv::v_setzero_s32();
+
+			// orientation bins of 4 gradients
+			auto bins= [&](const cv::v_float32x4& fx, const cv::v_float32x4& fy) {
+
+				cv::v_float32x4 ax= cv::v_abs(fx), ay= cv::v_abs(fy);
+				cv::v_float32x4 c= cv::v_min(ax, ay)/(cv::v_max(ax, ay) + eps);
+				cv::v_float32x4 c2= c*c;
+				cv::v_float32x4 a= (((p7*c2 + p5)*c2 + p3)*c2 + p1)*c;
+				a= cv::v_select(ax < ay, d90 - a, a);
+				a= cv::v_select(fx < zero, d180 - a, a);
+				a= cv::v_select(fy < zero, d360 - a, a);
+
+				cv::v_int32x4 bin= cv::v_round(a*half);
+				return cv::v_select(bin == wrap, first, bin);
+			};
+
+			// 8 pixels at a time, 16-bit derivatives
+			for (; x <= nc - 9; x+= 8) {
+
+				cv::v_int16x8 a0= cv::v_reinterpret_as_s16(cv::v_load_expand(r0 + x - 1));
+				cv::v_int16x8 a1= cv::v_reinterpret_as_s16(cv::v_load_expand(r0 + x));
+				cv::v_int16x8 a2= cv::v_reinterpret_as_s16(cv::v_load_expand(r0 + x + 1));
+				cv::v_int16x8 b0= cv::v_reinterpret_as_s16(cv::v_load_expand(r1 + x - 1));
+				cv::v_int16x8 b2= cv::v_reinterpret_as_s16(cv::v_load_expand(r1 + x + 1));
+				cv::v_int16x8 c0= cv::v_reinterpret_as_s16(cv::v_load_expand(r2 + x - 1));
+				cv::v_int16x8 c1= cv::v_reinterpret_as_s16(cv::v_load_expand(r2 + x));
+				cv::v_int16x8 c2= cv::v_reinterpret_as_s16(cv::v_load_expand(r2 + x + 1));
+
+				cv::v_int16x8 db= b2 - b0;
+				cv::v_int16x8 gx= (a2 - a0) + db + db + (c2 - c0);
+				cv::v_int16x8 gy= (c0 + c1 + c1 + c2) - (a0 + a1 + a1 + a2);
+
+				cv::v_int32x4 gx0, gx1, gy0, gy1;
+				cv::v_expand(gx, gx0, gx1);
+				cv::v_expand(gy, gy0, gy1);
+				cv::v_float32x4 fx0= cv::v_cvt_f32(gx0), fx1= cv::v_cvt_f32(gx1);
+				cv::v_float32x4 fy0= cv::v_cvt_f32(gy0), fy1= cv::v_cvt_f32(gy1);
+
+				if (l1) {
+					cv::v_store(m16 + x, cv::v_abs(gx) + cv::v_abs(gy));
+				} else {
+					cv::v_store(m32 + x, cv::v_sqrt(fx0*fx0 + fy0*fy0));
+					cv::v_store(m32 + x + 4, cv::v_sqrt(fx1*fx1 + fy1*fy1));
+				}
+				cv::v_pack_u_store(ori + x, cv::v_pack(bins(fx0, fy0), bins(fx1, fy1)));
+			}
+#endif
+
+			for (; x < nc; x++)
+				pixel(x);
+		}
+	}
+};
 
 class EdgeDetector {
 
@@ -43,6 +180,9 @@ class EdgeDetector {
 	  // Sobel orientation
 	  cv::Mat sobelOrientation;
 
+	  // Sobel orientation in 2-degree bins (fused computation)
+	  cv::Mat sobelBins;
+
   public:
 
 	  EdgeDetector() : aperture(3) {}
@@ -71,6 +211,7 @@ class EdgeDetector {
 
 		  // Compute magnitude and orientation
 		  cv::cartToPolar(sobelX, sobelY, sobelMagnitude, sobelOrientation);
+		  sobelBins.release();
 	  }
 
 	  // Compute the Sobel
@@ -82,6 +223,22 @@ class EdgeDetector {
 
 		  // Compute magnitude and orientation
 		  cv::cartToPolar(sobelX, sobelY, sobelMagnitude, sobelOrientation);
+		  sobelBins.release();
+	  }
+
+	  // Compute the Sobel magnitude and quantized orientation
+	  // in a single pass over a gray-level image (3x3 aperture only).
+	  // With the L1 norm, the magnitude is |dx|+|dy| in a CV_16U image.
+	  void computeFusedSobel(const cv::Mat& image, bool l1= false) {
+
+		  CV_Assert(image.type() == CV_8U && aperture == 3);
+
+		  sobelMagnitude.create(image.size(), l1 ? CV_16U : CV_32F);
+		  sobelBins.create(image.size(), CV_8U);
+		  sobelOrientation.release();
+
+		  cv::parallel_for_(cv::Range(0, image.rows),
+			  FusedSobel(image, sobelMagnitude, sobelBins));
 	  }
 
 	  // Get Sobel magnitude
@@ -90,9 +247,13 @@ class EdgeDetector {
 		  return sobelMagnitude;
 	  }
 
-	  // Get Sobel orientation
+	  // Get Sobel orientation (in radians)
 	  cv::Mat getOrientation() {
 
+		  // converted from the bins of the fused computation
+		  if (sobelOrientation.empty() && !sobelBins.empty())
+			  sobelBins.convertTo(sobelOrientation,CV_32F,PI/90);
+
 		  return sobelOrientation;
 	  }
 
@@ -100,7 +261,10 @@ class EdgeDetector {
 	  cv::Mat getBinaryMap(double threshold) {
 
 		  cv::Mat bin;		  
-		  cv::threshold(sobelMagnitude,bin,threshold,255,cv::THRESH_BINARY_INV);
+		  if (sobelMagnitude.depth() == CV_16U) // L1 magnitude
+			  cv::compare(sobelMagnitude,threshold,bin,cv::CMP_LE);
+		  else
+			  cv::threshold(sobelMagnitude,bin,threshold,255,cv::THRESH_BINARY_INV);
 
 		  return bin;
 	  }
@@ -121,6 +285,10 @@ class EdgeDetector {
 	  // 1 gray-level = 2 degrees
 	  cv::Mat getSobelOrientationImage() {
 
+		  // already quantized by the fused computation
+		  if (!sobelBins.empty())
+			  return sobelBins;
+
 		  cv::Mat bin;
 
 		  sobelOrientation.convertTo(bin,CV_8U,90/PI);
@@ -19,10 +19,16 @@ Copyright (C) 2016 Robert Laganiere, www.laganiere.name
 #if !defined LINEF
 #define LINEF
 
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 #define PI 3.1415926
 
+#include "orientedHough.h"
+
 class LineFinder {
 
   private:
@@ -48,23 +54,89 @@ class LineFinder {
 	  // max allowed gap along the line
 	  double maxGap;
 
+	  // line tracking (video) parameters:
+	  // only pixels at less than roiMargin from the previous lines vote
+	  int roiMargin;
+	  // the full frame votes every redetectInterval frames
+	  int redetectInterval;
+	  int frameCount;
+
+	  // accumulator of the votes along the gradient orientations
+	  OrientedHough hough;
+
+	  // edge pixels sorted by angle
+	  std::vector<cv::Point> points;
+	  std::vector<int> binStart;  // first point of each angle
+	  std::vector<uchar> used;    // point already on a line
+
+	  // extracts the segments of the line of angle t and distance index r
+	  // from the edge pixels that voted for it
+	  void extractSegments(int t, int r, std::vector<cv::Vec4i>& segments) {
+
+		  int nTheta= hough.numberOfAngles();
+		  int window= hough.getThetaWindow();
+
+		  // projections of the points on the line
+		  std::vector<std::pair<float, int> > line;
+		  for (int d= -window; d <= window; d++) {
+
+			  int b= (t + d + nTheta) % nTheta;
+			  for (int i= binStart[b]; i < binStart[b + 1]; i++) {
+
+				  if (used[i])
+					  continue;
+				  cv::Point2f p= hough.project(points[i], t);
+				  if (std::fabs(p.x - r) <= 1.0f)
+					  line.push_back(std::make_pair(p.y, i));
+			  }
+		  }
+
+		  std::sort(line.begin(), line.end());
+
+		  // runs of points with gaps smaller than maxGap
+		  float gap= static_cast<float>((maxGap + 1)/deltaRho);
+		  size_t first= 0;
+		  for (size_t i= 1; i <= line.size(); i++) {
+
+			  if (i < line.size() && line[i].first - line[i - 1].first <= gap)
+				  continue;
+
+			  cv::Point p1= points[line[first].second];
+			  cv::Point p2= points[line[i - 1].second];
+			  if (cv::norm(p2 - p1) >= minLength) {
+
+				  segments.push_back(cv::Vec4i(p1.x, p1.y, p2.x, p2.y));
+				  for (size_t j= first; j < i; j++)
+					  used[line[j].second]= 1;
+			  }
+
+			  first= i;
+		  }
+	  }
+
   public:
 
 	  // Default accumulator resolution is 1 pixel by 1 degree
 	  // no gap, no mimimum length
-	  LineFinder() : deltaRho(1), deltaTheta(PI/180), minVote(10), minLength(0.), maxGap(0.) {}
+	  LineFinder() : deltaRho(1), deltaTheta(PI/180), minVote(10), minLength(0.), maxGap(0.),
+		             roiMargin(10), redetectInterval(10), frameCount(0) {
+
+		  hough.setMinVote(minVote);
+	  }
 
 	  // Set the resolution of the accumulator
 	  void setAccResolution(double dRho, double dTheta) {
 
 		  deltaRho= dRho;
 		  deltaTheta= dTheta;
+		  hough.setAccResolution(dRho, dTheta);
 	  }
 
 	  // Set the minimum number of votes
 	  void setMinVote(int minv) {
 
 		  minVote= minv;
+		  hough.setMinVote(minv);
 	  }
 
 	  // Set line length and gap
@@ -83,6 +155,98 @@ class LineFinder {
 		  return lines;
 	  }
 
+	  // Set the line tracking parameters:
+	  // the number of accumulator angles voted on each side of the gradient orientation,
+	  // the distance to the previous lines of the pixels that vote
+	  // and the number of frames between two votes over the full frame
+	  void setTracking(int window, int margin, int interval) {
+
+		  CV_Assert(window >= 0 && margin >= 0 && interval > 0);
+		  hough.setThetaWindow(window);
+		  roiMargin= margin;
+		  redetectInterval= interval;
+	  }
+
+	  // Forget the lines of the previous frame
+	  void resetTracking() {
+
+		  lines.clear();
+		  frameCount= 0;
+	  }
+
+	  // Find the lines of a video frame from its binary edge map
+	  // and the gradient orientations in 2-degree bins (EdgeDetector::getSobelOrientationImage).
+	  // Each edge pixel votes only for the angles close to its gradient orientation
+	  // and, between full-frame detections, only pixels near the lines
+	  // found in the previous frame vote.
+	  std::vector<cv::Vec4i> trackLines(const cv::Mat& binary, const cv::Mat& orientations) {
+
+		  CV_Assert(binary.type() == CV_8U && orientations.type() == CV_8U && binary.size() == orientations.size());
+
+		  // regions of interest around the previous lines
+		  bool full= lines.empty() || frameCount % redetectInterval == 0;
+		  frameCount++;
+		  cv::Mat roi;
+		  cv::Rect area(0, 0, binary.cols, binary.rows);
+		  if (!full) {
+
+			  roi= cv::Mat::zeros(binary.size(), CV_8U);
+			  int xmin= binary.cols, ymin= binary.rows, xmax= 0, ymax= 0;
+			  for (size_t i= 0; i < lines.size(); i++) {
+
+				  cv::Point p1(lines[i][0], lines[i][1]), p2(lines[i][2], lines[i][3]);
+				  cv::line(roi, p1, p2, cv::Scalar(255), 2*roiMargin + 1);
+				  xmin= std::min(xmin, std::min(p1.x, p2.x));
+				  ymin= std::min(ymin, std::min(p1.y, p2.y));
+				  xmax= std::max(xmax, std::max(p1.x, p2.x));
+				  ymax= std::max(ymax, std::max(p1.y, p2.y));
+			  }
+			  area&= cv::Rect(xmin - roiMargin, ymin - roiMargin,
+				              xmax - xmin + 2*roiMargin + 1, ymax - ymin + 2*roiMargin + 1);
+		  }
+
+		  hough.vote(binary, orientations, area, roi);
+		  int nTheta= hough.numberOfAngles();
+
+		  // edge pixels sorted by the accumulator angle of their orientation
+		  binStart.assign(nTheta + 1, 0);
+		  std::vector<std::pair<int, cv::Point> > edges;
+		  for (int y= area.y; y < area.y + area.height; y++) {
+
+			  const uchar* in= binary.ptr<uchar>(y);
+			  const uchar* ori= orientations.ptr<uchar>(y);
+			  const uchar* mask= full ? 0 : roi.ptr<uchar>(y);
+
+			  for (int x= area.x; x < area.x + area.width; x++) {
+
+				  if (in[x] && (full || mask[x])) {
+
+					  int t= hough.angleOf(ori[x]);
+					  edges.push_back(std::make_pair(t, cv::Point(x, y)));
+					  binStart[t + 1]++;
+				  }
+			  }
+		  }
+
+		  for (int t= 0; t < nTheta; t++)
+			  binStart[t + 1]+= binStart[t];
+		  points.resize(edges.size());
+		  std::vector<int> next(binStart.begin(), binStart.end() - 1);
+		  for (size_t i= 0; i < edges.size(); i++)
+			  points[next[edges[i].first]++]= edges[i].second;
+		  used.assign(points.size(), 0);
+
+		  // local maxima with enough votes, strongest first
+		  std::vector<std::pair<int, cv::Point> > peaks= hough.findPeaks();
+
+		  // segments along the peak lines, each edge pixel being used once
+		  lines.clear();
+		  for (size_t i= 0; i < peaks.size(); i++)
+			  extractSegments(peaks[i].second.y, peaks[i].second.x, lines);
+
+		  return lines;
+	  }
+
 	  // Draw the detected lines on an image
 	  void drawDetectedLines(cv::Mat &image, cv::Scalar color=cv::Scalar(255,255,255)) {
 	
@@ -0,0 +1,401 @@
+/*------------------------------------------------------------------------------------------*\
+This file contains material supporting chapter 7 of the book:
+OpenCV3 Computer Vision Application Programming Cookbook
+Third Edition
+by Robert Laganiere, Packt Publishing, 2016.
+
+This program is free software; permission is hereby granted to use, copy, modify,
+and distribute this source code, or portions thereof, for any purpose, without fee,
+subject to the restriction that the copyright notice may not be removed
+or altered from any source or altered source distribution.
+The software is released on an as-is basis and without any warranties of any kind.
+In particular, the software is not guaranteed to be fault-tolerant or free from failure.
+The author disclaims all warranties with regard to this software, any use,
+and any consequent failure, is purely the responsibility of the user.
+
+Copyright (C) 2016 Robert Laganiere, www.laganiere.name
+\*------------------------------------------------------------------------------------------*/
+
+#if !defined OHOUGH
+#define OHOUGH
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#define PI 3.1415926
+
+// Votes of the edge pixels of bands of rows, each band in its own accumulator.
+// A pixel only votes for the angles close to its gradient orientation.
+// Only the pixels of an area, and of a mask if it is not empty, vote.
+// voted[b][t] flags the angles that band b voted for: only these rows
+// are cleared before voting, the other ones are already at 0.
+class OrientedVotes : public cv::ParallelLoopBody {
+
+	const cv::Mat& binary;
+	const cv::Mat& orientations;  // 2-degree bins
+	const cv::Mat& mask;
+	cv::Rect area;
+	std::vector<cv::Mat>& accumulators;
+	std::vector<std::vector<uchar> >& voted;
+	const std::vector<float>& cosTable;
+	const std::vector<float>& sinTable;
+	const std::vector<int>& angles; // accumulator angle of each orientation bin
+	int window;
+
+  public:
+
+	OrientedVotes(const cv::Mat& binary, const cv::Mat& orientations, const cv::Mat& mask, cv::Rect area,
+		          std::vector<cv::Mat>& accumulators, std::vector<std::vector<uchar> >& voted,
+		          const std::vector<float>& cosTable, const std::vector<float>& sinTable,
+		          const std::vector<int>& angles, int window)
+		: binary(binary), orientations(orientations), mask(mask), area(area), accumulators(accumulators),
+		  voted(voted), cosTable(cosTable), sinTable(sinTable), angles(angles), window(window) {}
+
+	void operator()(const cv::Range& range) const {
+
+		int bands= static_cast<int>(accumulators.size());
+
+		for (int b= range.start; b < range.end; b++) {
+
+			cv::Mat& acc= accumulators[b];
+			std::vector<uchar>& touched= voted[b];
+			int nTheta= acc.rows;
+			int offset= acc.cols/2;
+
+			// clears the votes of the previous call
+			for (int t= 0; t < nTheta; t++) {
+
+				if (touched[t]) {
+
+					acc.row(t).setTo(0);
+					touched[t]= 0;
+				}
+			}
+
+			for (int y= area.y + b*area.height/bands; y < area.y + (b + 1)*area.height/bands; y++) {
+
+				const uchar* in= binary.ptr<uchar>(y);
+				const uchar* ori= orientations.ptr<uchar>(y);
+				const uchar* m= mask.empty() ? 0 : mask.ptr<uchar>(y);
+
+				for (int x= area.x; x < area.x + area.width; x++) {
+
+					if (!in[x] || (m && !m[x]))
+						continue;
+
+					// the window of angles wraps around at 180 degrees
+					int t0= angles[ori[x]] + nTheta;
+					for (int d= -window; d <= window; d++) {
+
+						int t= (t0 + d) % nTheta;
+						acc.ptr<int>(t)[offset + cvRound(x*cosTable[t] + y*sinTable[t])]++;
+						touched[t]= 1;
+					}
+				}
+			}
+		}
+	}
+};
+
+// Sums the accumulators of the bands, row by row
+class VoteReduction : public cv::ParallelLoopBody {
+
+	const std::vector<cv::Mat>& accumulators;
+	cv::Mat& sum;
+
+  public:
+
+	VoteReduction(const std::vector<cv::Mat>& accumulators, cv::Mat& sum)
+		: accumulators(accumulators), sum(sum) {}
+
+	void operator()(const cv::Range& range) const {
+
+		int n= sum.cols;
+
+		for (int t= range.start; t < range.end; t++) {
+
+			int* out= sum.ptr<int>(t);
+			accumulators[0].row(t).copyTo(sum.row(t));
+
+			for (size_t b= 1; b < accumulators.size(); b++) {
+
+				const int* in= accumulators[b].ptr<int>(t);
+				int r= 0;
+#if CV_SIMD128
+				for (; r <= n - 4; r+= 4)
+					cv::v_store(out + r, cv::v_load(out + r) + cv::v_load(in + r));
+#endif
+				for (; r < n; r++)
+					out[r]+= in[r];
+			}
+		}
+	}
+};
+
+// Sums the rows of the band accumulators that received votes;
+// the rows of the sum listed in rows that no band voted for are cleared
+class VotedRowReduction : public cv::ParallelLoopBody {
+
+	const std::vector<cv::Mat>& accumulators;
+	const std::vector<std::vector<uchar> >& voted;
+	const std::vector<int>& rows;
+	cv::Mat& sum;
+
+  public:
+
+	VotedRowReduction(const std::vector<cv::Mat>& accumulators, const std::vector<std::vector<uchar> >& voted,
+		              const std::vector<int>& rows, cv::Mat& sum)
+		: accumulators(accumulators), voted(voted), rows(rows), sum(sum) {}
+
+	void operator()(const cv::Range& range) const {
+
+		int n= sum.cols;
+
+		for (int i= range.start; i < range.end; i++) {
+
+			int t= rows[i];
+			int* out= sum.ptr<int>(t);
+			bool first= true;
+
+			for (size_t b= 0; b < accumulators.size(); b++) {
+
+				if (!voted[b][t])
+					continue;
+
+				if (first) {
+
+					accumulators[b].row(t).copyTo(sum.row(t));
+					first= false;
+					continue;
+				}
+
+				const int* in= accumulators[b].ptr<int>(t);
+				int r= 0;
+#if CV_SIMD128
+				for (; r <= n - 4; r+= 4)
+					cv::v_store(out + r, cv::v_load(out + r) + cv::v_load(in + r));
+#endif
+				for (; r < n; r++)
+					out[r]+= in[r];
+			}
+
+			if (first)
+				sum.row(t).setTo(0);
+		}
+	}
+};
+
+// Hough transform for lines (same output as cv::HoughLines)
+// in which each edge pixel only votes for the angles within
+// +/- a window of its gradient orientation.
+// Bands of rows vote in parallel in separate accumulators that are then summed.
+// The accumulators are kept from call to call: only the angles that received
+// votes are cleared, summed and searched for peaks.
+// The accumulator has one row per angle t (in [0,180[ degrees)
+// and one column per distance index r (rho= r*deltaRho).
+class OrientedHough {
+
+	// accumulator resolution parameters
+	double deltaRho;
+	double deltaTheta;
+
+	// number of angles voted on each side of the gradient orientation
+	int window;
+
+	// minimum number of votes that a line
+	// must receive before being considered
+	int minVote;
+
+	// accumulator (one row of rho values per angle)
+	cv::Mat accumulator;
+	std::vector<uchar> summed;     // rows of the accumulator that may be non-zero
+	std::vector<cv::Mat> partial;  // one per band
+	std::vector<std::vector<uchar> > voted; // rows of each band that received votes
+	std::vector<int> rows;         // rows to be summed
+	std::vector<float> cosTable, sinTable;
+	std::vector<int> angles;       // accumulator angle of each orientation bin
+
+	// allocates the accumulators and the tables
+	// when the image size, the resolution or the number of threads change
+	void init(cv::Size size) {
+
+		int nTheta= cvRound(PI/deltaTheta);
+		int nRho= 2*cvCeil(std::sqrt(static_cast<double>(size.width*size.width + size.height*size.height))/deltaRho) + 1;
+		size_t bands= std::max(cv::getNumThreads(), 1);
+
+		if (accumulator.rows == nTheta && accumulator.cols == nRho && partial.size() == bands)
+			return;
+
+		accumulator.create(nTheta, nRho, CV_32S);
+		accumulator.setTo(0);
+		summed.assign(nTheta, 0);
+		partial.resize(bands);
+		voted.resize(bands);
+		for (size_t b= 0; b < bands; b++) {
+
+			partial[b].create(nTheta, nRho, CV_32S);
+			partial[b].setTo(0);
+			voted[b].assign(nTheta, 0);
+		}
+
+		cosTable.resize(nTheta);
+		sinTable.resize(nTheta);
+		for (int t= 0; t < nTheta; t++) {
+
+			cosTable[t]= static_cast<float>(std::cos(t*deltaTheta)/deltaRho);
+			sinTable[t]= static_cast<float>(std::sin(t*deltaTheta)/deltaRho);
+		}
+
+		// the line normal is the gradient orientation modulo 180 degrees
+		angles.resize(256);
+		for (int bin= 0; bin < 256; bin++)
+			angles[bin]= cvRound((bin % 90)*PI/90/deltaTheta) % nTheta;
+	}
+
+  public:
+
+	// Default accumulator resolution is 1 pixel by 1 degree
+	// with votes over +/- 3 degrees
+	OrientedHough() : deltaRho(1), deltaTheta(PI/180), window(3), minVote(50) {}
+
+	// Set the resolution of the accumulator
+	void setAccResolution(double dRho, double dTheta) {
+
+		deltaRho= dRho;
+		deltaTheta= dTheta;
+		accumulator.release();
+	}
+
+	// Set the number of angles voted on each side of the gradient orientation
+	// (the orientation is quantized to 2 degrees)
+	void setThetaWindow(int k) {
+
+		window= k;
+	}
+
+	int getThetaWindow() const {
+
+		return window;
+	}
+
+	// Set the minimum number of votes
+	void setMinVote(int minv) {
+
+		minVote= minv;
+	}
+
+	// Fills the accumulator with the votes of the edge pixels of an area
+	// given the gradient orientations in 2-degree bins (EdgeDetector::getSobelOrientationImage).
+	// If the mask is not empty, only its non-zero pixels vote.
+	void vote(const cv::Mat& binary, const cv::Mat& orientations, cv::Rect area, const cv::Mat& mask= cv::Mat()) {
+
+		CV_Assert(binary.type() == CV_8U && orientations.type() == CV_8U && binary.size() == orientations.size());
+		CV_Assert(mask.empty() || (mask.type() == CV_8U && mask.size() == binary.size()));
+		CV_Assert(2*window + 1 <= cvRound(PI/deltaTheta));
+
+		init(binary.size());
+		area&= cv::Rect(0, 0, binary.cols, binary.rows);
+
+		cv::parallel_for_(cv::Range(0, static_cast<int>(partial.size())),
+			OrientedVotes(binary, orientations, mask, area, partial, voted, cosTable, sinTable, angles, window));
+
+		// the rows voted now, and those of the previous call to be cleared
+		rows.clear();
+		for (int t= 0; t < accumulator.rows; t++) {
+
+			bool any= false;
+			for (size_t b= 0; b < voted.size(); b++)
+				any= any || voted[b][t];
+
+			if (any || summed[t])
+				rows.push_back(t);
+			summed[t]= any;
+		}
+
+		cv::parallel_for_(cv::Range(0, static_cast<int>(rows.size())),
+			VotedRowReduction(partial, voted, rows, accumulator));
+	}
+
+	// Local maxima of the accumulator with more than minVote votes, as in cv::HoughLines,
+	// as (votes, (r,t)) pairs sorted by decreasing number of votes
+	std::vector<std::pair<int, cv::Point> > findPeaks() const {
+
+		int nTheta= accumulator.rows;
+		int nRho= accumulator.cols;
+		int offset= nRho/2;
+
+		std::vector<std::pair<int, cv::Point> > peaks;
+		for (int t= 0; t < nTheta; t++) {
+
+			// the other rows are all 0
+			if (!summed[t])
+				continue;
+
+			// the accumulator wraps around at 180 degrees with the sign of rho reversed:
+			// the neighbour of (r,0) at -1 degree is the cell (-r,nTheta-1)
+			const int* previous= accumulator.ptr<int>((t + nTheta - 1) % nTheta);
+			const int* current= accumulator.ptr<int>(t);
+			const int* next= accumulator.ptr<int>((t + 1) % nTheta);
+			int rp= t == 0 ? nRho - 1 : 0;
+			int rn= t == nTheta - 1 ? nRho - 1 : 0;
+
+			for (int r= 1; r < nRho - 1; r++) {
+
+				int v= current[r];
+				if (v > minVote && v > current[r - 1] && v >= current[r + 1] &&
+					v > previous[rp ? rp - r : r] && v >= next[rn ? rn - r : r])
+					peaks.push_back(std::make_pair(v, cv::Point(r - offset, t)));
+			}
+		}
+		std::stable_sort(peaks.begin(), peaks.end(),
+			[](const std::pair<int, cv::Point>& a, const std::pair<int, cv::Point>& b) { return a.first > b.first; });
+
+		return peaks;
+	}
+
+	// Detects the lines (rho, theta) of a binary edge map
+	// given the gradient orientations in 2-degree bins (EdgeDetector::getSobelOrientationImage).
+	// Lines are sorted by decreasing number of votes.
+	std::vector<cv::Vec2f> findLines(const cv::Mat& binary, const cv::Mat& orientations) {
+
+		vote(binary, orientations, cv::Rect(0, 0, binary.cols, binary.rows));
+		std::vector<std::pair<int, cv::Point> > peaks= findPeaks();
+
+		std::vector<cv::Vec2f> lines(peaks.size());
+		for (size_t i= 0; i < peaks.size(); i++)
+			lines[i]= cv::Vec2f(static_cast<float>(peaks[i].second.x*deltaRho),
+			                    static_cast<float>(peaks[i].second.y*deltaTheta));
+
+		return lines;
+	}
+
+	// number of angles of the accumulator
+	int numberOfAngles() const {
+
+		return accumulator.rows;
+	}
+
+	// accumulator angle of an orientation bin
+	int angleOf(int bin) const {
+
+		return angles[bin];
+	}
+
+	// coordinates of a point in the frame of the lines of angle t, in rho units:
+	// its distance index and its position along these lines
+	cv::Point2f project(cv::Point p, int t) const {
+
+		return cv::Point2f(p.x*cosTable[t] + p.y*sinTable[t], p.x*sinTable[t] - p.y*cosTable[t]);
+	}
+
+	// Get the accumulator of the last detection
+	cv::Mat getAccumulator() const {
+
+		return accumulator;
+	}
+};
+
+#endif
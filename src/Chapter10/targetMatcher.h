@@ -31,6 +31,8 @@ Copyright (C) 2016 Robert Laganiere, www.laganiere.name
 #include <opencv2/calib3d.hpp>
 #include <opencv2/features2d.hpp>
 
+#include "../Chapter06/scaleSpace.h"
+
 class TargetMatcher {
 
   private:
@@ -45,6 +47,7 @@ class TargetMatcher {
 	  int numberOfLevels;  // pyramid size
 	  double scaleFactor;  // scale between levels
 	  // the pyramid of target images and its keypoints
+	  GaussianScaleSpace scaleSpace;
 	  std::vector<cv::Mat> pyramid; 
 	  std::vector<std::vector<cv::KeyPoint>> pyrKeypoints;
 	  std::vector<cv::Mat> pyrDescriptors;
@@ -53,17 +56,18 @@ class TargetMatcher {
 	  void createPyramid() {
 
 		  // create the pyramid of target images
+		  // each octave is a reduced target image, slightly blurred
+		  // before reduction to avoid aliasing
+		  // (small targets have fewer octaves than requested)
+		  scaleSpace.compute(target);
 		  pyramid.clear();
-		  cv::Mat layer(target);
-		  for (int i = 0; i < numberOfLevels; i++) { // reduce size at each layer
-			  pyramid.push_back(target.clone());
-			  resize(target, target, cv::Size(), scaleFactor, scaleFactor);
-		  }
+		  for (int i = 0; i < scaleSpace.numberOfOctaves(); i++)
+			  pyramid.push_back(scaleSpace.getLevel(i, 0));
 
 		  pyrKeypoints.clear();
 		  pyrDescriptors.clear();
 		  // keypoint detection and description in pyramid
-		  for (int i = 0; i < numberOfLevels; i++) {
+		  for (size_t i = 0; i < pyramid.size(); i++) {
 			  // detect target keypoints at level i
 			  pyrKeypoints.push_back(std::vector<cv::KeyPoint>());
 			  detector->detect(pyramid[i], pyrKeypoints[i]);
@@ -87,6 +91,12 @@ class TargetMatcher {
 		  if (!this->descriptor) {
 			  this->descriptor = this->detector;
 		  }
+
+		  // one 8-bit image per pyramid level
+		  scaleSpace.setOctaves(numberOfLevels, scaleFactor);
+		  scaleSpace.setSigmas(std::vector<double>(1, 0.5));
+		  scaleSpace.setDepth(CV_8U);
+		  scaleSpace.setDoG(false);
 	  }
 
 	  // Set the norm to be used for matching
@@ -178,7 +188,7 @@ class TargetMatcher {
 		  cv::BFMatcher matcher(normType);
 
 		  // 2. robustly find homography for each pyramid level
-		  for (int i = 0; i < numberOfLevels; i++) {
+		  for (size_t i = 0; i < pyramid.size(); i++) {
 			  // find a RANSAC homography between target and image
 			  matches.clear();
 
@@ -200,7 +210,7 @@ class TargetMatcher {
 
 			  if (VERBOSE) {
 				  cv::Mat imageMatches;
-				  cv::drawMatches(target, pyrKeypoints[i],  // 1st image and its keypoints
+				  cv::drawMatches(pyramid[i], pyrKeypoints[i],  // 1st image and its keypoints
 					  image, keypoints,  // 2nd image and its keypoints
 					  inliers,			// the matches
 					  imageMatches,		// the image produced